@@ -0,0 +1,153 @@
+//Background embedding (createPYTHIA DOEMBED): heavy-ion-like thermal background events, explicit ghosts for active
+//jet areas and a grid-median estimate of the background pt density rho, for rho*area subtraction per jet
+//Background events are made once into an in-memory pool and recycled; the ghosts are made once and appended to every event
+
+#ifndef BACKGROUNDEMBEDUTIL_H
+#define BACKGROUNDEMBEDUTIL_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+#include "TRandom3.h"
+
+//as fastjet::GhostedAreaSpec, small enough to leave any real jet's kinematics unchanged
+const Double_t embedGhostPt = 1e-100;
+
+//One background event (or the ghost set); four-vectors ready for clustering + pt/eta/phi for rho
+struct embedParticles
+{
+  std::vector<Double_t> px, py, pz, e;
+  std::vector<Float_t> pt, eta, phi;
+};
+
+inline void addEmbedParticle(const Double_t pt, const Double_t eta, const Double_t phi, const Double_t m, embedParticles* outParticles)
+{
+  const Double_t pz = pt*std::sinh(eta);
+  outParticles->px.push_back(pt*std::cos(phi));
+  outParticles->py.push_back(pt*std::sin(phi));
+  outParticles->pz.push_back(pz);
+  outParticles->e.push_back(std::sqrt(pt*pt + pz*pz + m*m));
+  outParticles->pt.push_back(pt);
+  outParticles->eta.push_back(eta);
+  outParticles->phi.push_back(phi);
+  return;
+}
+
+//nPart pions, uniform in |eta| < absEtaMax + phi, pt from the Boltzmann-like dN/dpt ~ pt*exp(-pt/T), i.e. a Gamma(2, T) draw
+inline void generateThermalEvent(TRandom3* randGen_p, const Int_t nPart, const Float_t temperature, const Float_t absEtaMax, embedParticles* outParticles)
+{
+  const Float_t pionMass = 0.13957;
+
+  *outParticles = embedParticles();
+  for(Int_t pI = 0; pI < nPart; ++pI){
+    //Rndm() is in (0, 1], so the log is finite
+    const Double_t pt = -temperature*std::log(randGen_p->Rndm()*randGen_p->Rndm());
+    addEmbedParticle(pt, randGen_p->Uniform(-absEtaMax, absEtaMax), randGen_p->Uniform(-TMath::Pi(), TMath::Pi()), pionMass, outParticles);
+  }
+  return;
+}
+
+//One ghost of pt embedGhostPt per cell of area ~ghostArea covering |eta| < absEtaMax, placed randomly within its cell
+//Jet area is then (ghosts among the constituents)*getGhostCellArea(absEtaMax, ghostArea)
+inline Int_t getNGhostEta(const Float_t absEtaMax, const Float_t ghostArea){return TMath::Max(1, (Int_t)std::ceil(2.0*absEtaMax/std::sqrt(ghostArea)));}
+inline Int_t getNGhostPhi(const Float_t ghostArea){return TMath::Max(1, (Int_t)std::ceil(2.0*TMath::Pi()/std::sqrt(ghostArea)));}
+inline Double_t getGhostCellArea(const Float_t absEtaMax, const Float_t ghostArea){return (2.0*absEtaMax/getNGhostEta(absEtaMax, ghostArea))*(2.0*TMath::Pi()/getNGhostPhi(ghostArea));}
+
+inline void generateGhosts(TRandom3* randGen_p, const Float_t absEtaMax, const Float_t ghostArea, embedParticles* outGhosts)
+{
+  const Int_t nEta = getNGhostEta(absEtaMax, ghostArea);
+  const Int_t nPhi = getNGhostPhi(ghostArea);
+  const Double_t etaWidth = 2.0*absEtaMax/nEta;
+  const Double_t phiWidth = 2.0*TMath::Pi()/nPhi;
+
+  *outGhosts = embedParticles();
+  for(Int_t eI = 0; eI < nEta; ++eI){
+    for(Int_t pI = 0; pI < nPhi; ++pI){
+      const Double_t eta = -absEtaMax + (eI + randGen_p->Rndm())*etaWidth;
+      const Double_t phi = -TMath::Pi() + (pI + randGen_p->Rndm())*phiWidth;
+      addEmbedParticle(embedGhostPt, eta, phi, 0.0, outGhosts);
+    }
+  }
+  return;
+}
+
+//Median over grid cells (|eta| < absEtaMax, full phi) of the cell pt sum/cell area, as fastjet::GridMedianBackgroundEstimator
+//Needs no clustering, so one estimate per event serves all R; empty cells count, jets only populate a few cells
+class gridMedianRho
+{
+ public:
+  gridMedianRho(){};
+  ~gridMedianRho(){};
+
+  bool Init(const Float_t absEtaMax, const Float_t cellSize);
+  void Reset();
+  //Particles outside |eta| < absEtaMax are ignored
+  void Add(const Float_t pt, const Float_t eta, const Float_t phi);
+  Double_t GetRho();
+
+ private:
+  Double_t m_absEtaMax = 0.0;
+  Int_t m_nEta = 0;
+  Int_t m_nPhi = 0;
+  Double_t m_etaWidth = 0.0;
+  Double_t m_phiWidth = 0.0;
+  std::vector<Double_t> m_cellPt;
+  std::vector<Double_t> m_scratch;
+};
+
+bool gridMedianRho::Init(const Float_t absEtaMax, const Float_t cellSize)
+{
+  if(absEtaMax <= 0.0 || cellSize <= 0.0){
+    std::cout << __PRETTY_FUNCTION__ << ": given absEtaMax '" << absEtaMax << "' and cellSize '" << cellSize << "' must be > 0. return false" << std::endl;
+    return false;
+  }
+
+  m_absEtaMax = absEtaMax;
+  m_nEta = TMath::Max(1, (Int_t)std::round(2.0*absEtaMax/cellSize));
+  m_nPhi = TMath::Max(1, (Int_t)std::round(2.0*TMath::Pi()/cellSize));
+  m_etaWidth = 2.0*absEtaMax/m_nEta;
+  m_phiWidth = 2.0*TMath::Pi()/m_nPhi;
+  m_cellPt.assign(m_nEta*m_nPhi, 0.0);
+  return true;
+}
+
+void gridMedianRho::Reset()
+{
+  std::fill(m_cellPt.begin(), m_cellPt.end(), 0.0);
+  return;
+}
+
+void gridMedianRho::Add(const Float_t pt, const Float_t eta, const Float_t phi)
+{
+  if(eta <= -m_absEtaMax || eta >= m_absEtaMax) return;
+
+  //phi in [-pi, pi] mapped onto [0, nPhi)
+  const Int_t etaPos = TMath::Min(m_nEta - 1, (Int_t)((eta + m_absEtaMax)/m_etaWidth));
+  Double_t phiPos = phi + TMath::Pi();
+  if(phiPos < 0.0) phiPos += 2.0*TMath::Pi();
+  const Int_t phiPosI = TMath::Min(m_nPhi - 1, (Int_t)(phiPos/m_phiWidth));
+  m_cellPt[etaPos*m_nPhi + phiPosI] += pt;
+  return;
+}
+
+Double_t gridMedianRho::GetRho()
+{
+  m_scratch = m_cellPt;
+  const unsigned int nCells = m_scratch.size();
+  if(nCells == 0) return 0.0;
+
+  std::nth_element(m_scratch.begin(), m_scratch.begin() + nCells/2, m_scratch.end());
+  Double_t median = m_scratch[nCells/2];
+  if(nCells%2 == 0){
+    median += *std::max_element(m_scratch.begin(), m_scratch.begin() + nCells/2);
+    median /= 2.0;
+  }
+  return median/(m_etaWidth*m_phiWidth);
+}
+
+#endif
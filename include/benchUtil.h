@@ -0,0 +1,119 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+//c+cpp
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+#include "TString.h"
+#include "TSystem.h"
+
+//local
+#include "include/stringUtil.h"
+
+//Accumulating wall-clock stopwatch for benchmark loops
+class benchTimer
+{
+ public:
+  benchTimer(){};
+  ~benchTimer(){};
+
+  void Start();
+  void Stop();
+  void Reset();
+  Double_t GetSeconds() const;
+
+ private:
+  std::chrono::steady_clock::time_point m_start;
+  Double_t m_seconds = 0.0;
+};
+
+void benchTimer::Start(){m_start = std::chrono::steady_clock::now(); return;}
+
+void benchTimer::Stop()
+{
+  m_seconds += std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - m_start).count();
+  return;
+}
+
+void benchTimer::Reset(){m_seconds = 0.0; return;}
+
+Double_t benchTimer::GetSeconds() const {return m_seconds;}
+
+//Machine-readable benchmark record, written as JSON for tracking across commits
+//Input params (event counts, seeds, radii) + named results w/ units; env BENCHTAG (e.g. the commit hash) labels the run
+class benchRecord
+{
+ public:
+  benchRecord(const std::string benchName);
+  ~benchRecord(){};
+
+  void AddParam(const std::string paramName, const std::string paramVal);
+  void AddResult(const std::string resultName, const Double_t resultVal, const std::string unit);
+  //Does nothing for an empty outFileName
+  bool WriteJSON(const std::string outFileName) const;
+
+ private:
+  std::string m_benchName;
+  std::vector<std::string> m_paramNames, m_paramVals;
+  std::vector<std::string> m_resultNames, m_resultUnits;
+  std::vector<Double_t> m_resultVals;
+};
+
+benchRecord::benchRecord(const std::string benchName){m_benchName = benchName; return;}
+
+void benchRecord::AddParam(const std::string paramName, const std::string paramVal)
+{
+  m_paramNames.push_back(paramName);
+  m_paramVals.push_back(paramVal);
+  return;
+}
+
+void benchRecord::AddResult(const std::string resultName, const Double_t resultVal, const std::string unit)
+{
+  m_resultNames.push_back(resultName);
+  m_resultVals.push_back(resultVal);
+  m_resultUnits.push_back(unit);
+  return;
+}
+
+bool benchRecord::WriteJSON(const std::string outFileName) const
+{
+  if(outFileName.size() == 0) return true;
+
+  std::ofstream outFile(outFileName.c_str());
+  if(!outFile.is_open()){
+    std::cout << __PRETTY_FUNCTION__ << ": cannot open '" << outFileName << "' for writing. return false" << std::endl;
+    return false;
+  }
+
+  std::string benchTag = "";
+  if(gSystem->Getenv("BENCHTAG") != nullptr) benchTag = gSystem->Getenv("BENCHTAG");
+
+  //Names + values are generated by the benchmarks themselves, no escaping needed; non-finite results (e.g. 0 s timers) are null
+  outFile << "{" << std::endl;
+  outFile << "  \"bench\": \"" << m_benchName << "\"," << std::endl;
+  outFile << "  \"tag\": \"" << benchTag << "\"," << std::endl;
+  outFile << "  \"date\": \"" << getDateStr() << "\"," << std::endl;
+  outFile << "  \"params\": {";
+  for(unsigned int pI = 0; pI < m_paramNames.size(); ++pI){
+    outFile << (pI == 0 ? "" : ",") << std::endl << "    \"" << m_paramNames[pI] << "\": \"" << m_paramVals[pI] << "\"";
+  }
+  outFile << std::endl << "  }," << std::endl;
+  outFile << "  \"results\": [";
+  for(unsigned int rI = 0; rI < m_resultNames.size(); ++rI){
+    outFile << (rI == 0 ? "" : ",") << std::endl << "    {\"name\": \"" << m_resultNames[rI] << "\", \"value\": " << (TMath::Finite(m_resultVals[rI]) ? Form("%.6g", m_resultVals[rI]) : "null") << ", \"unit\": \"" << m_resultUnits[rI] << "\"}";
+  }
+  outFile << std::endl << "  ]" << std::endl;
+  outFile << "}" << std::endl;
+  outFile.close();
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,188 @@
+//Bootstrap replicas of a jet spectrum, filled in the same pass as the spectrum itself (createJetSpectraAndShapes NBOOTSTRAP)
+//Replica b weights every event by its own Poisson(1) count, drawn from a counter-based stream keyed on the event: no generator
+//state, so the counts depend only on (BOOTSTRAPSEED, generator RANDOMSEED, evtnum) and are identical for any threading,
+//batching or sharding of the input
+//Sums are kept bin-major, [bin][replica], so a selected jet adds to one contiguous run; output is one TH2 (pt bin x replica)
+
+#ifndef BOOTSTRAPACCUMULATOR_H
+#define BOOTSTRAPACCUMULATOR_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//ROOT
+#include "TH2.h"
+#include "TMath.h"
+
+//local
+#include "include/randomUtil.h"
+
+//Poisson(1) counts are capped here, P(k > 20) ~ 1e-20; also keeps the inverse CDF finite when the cdf rounds below u
+const Int_t maxPoisson1Count = 20;
+
+//Poisson(1) count from u in [0, 1) by inverse CDF, ~2 iterations on average
+inline UChar_t getPoisson1(const Double_t uniform)
+{
+  Double_t prob = 0.36787944117144233;
+  Double_t cdf = prob;
+  Int_t count = 0;
+  while(uniform >= cdf && count < maxPoisson1Count){
+    ++count;
+    prob /= count;
+    cdf += prob;
+  }
+  return (UChar_t)count;
+}
+
+//Key of the event streams of one input: generator runs w/ different RANDOMSEED reuse the same evtnum values
+inline ULong64_t getBootstrapInputKey(const ULong64_t bootstrapSeed, const ULong64_t generatorSeed)
+{
+  return splitMix64(splitMix64(bootstrapSeed) ^ generatorSeed);
+}
+
+//Replica counts of nEvents events, nReplicas per event: (*outWeights)[eI*nReplicas + bI]
+inline void getBootstrapReplicaWeights(const Long64_t nEvents, const ULong64_t* evtnum, const ULong64_t inputKey, const Int_t nReplicas, std::vector<UChar_t>* outWeights)
+{
+  outWeights->resize(nEvents*nReplicas);
+  UChar_t* weights_p = outWeights->data();
+  for(Long64_t eI = 0; eI < nEvents; ++eI){
+    const ULong64_t eventKey = splitMix64(inputKey ^ evtnum[eI]);
+    for(Int_t bI = 0; bI < nReplicas; ++bI){
+      weights_p[eI*nReplicas + bI] = getPoisson1(getCounterUniform(eventKey, bI));
+    }
+  }
+  return;
+}
+
+class bootstrapAccumulator
+{
+ public:
+  bootstrapAccumulator(){};
+  ~bootstrapAccumulator(){};
+
+  //binEdges has nBins+1 entries, as spectrumAccumulator::Init
+  bool Init(const Int_t nBins, const Double_t* binEdges, const Int_t nReplicas);
+  void Reset();
+
+  //Events [0, nEvents), event e owning jets [offsets[e], offsets[e+1]) of pt/eta; same selection + binning as spectrumAccumulator::FillJets
+  //replicaWeights holds the nReplicas counts of each event, eventWeights is nullptr for unweighted input
+  void FillEvents(const Long64_t nEvents, const Long64_t* offsets, const Float_t* pt, const Float_t* eta, const Float_t absEtaMax, const Float_t ptMin, const Float_t ptMax, const Float_t* eventWeights, const UChar_t* replicaWeights);
+  void Add(const bootstrapAccumulator& inAcc, const Double_t scale = 1.0);
+
+  //x: the nBins pt bins, y: the nReplicas replicas; contents + entries only, replica spread is the uncertainty
+  bool WriteToTH2(TH2* inHist_p) const;
+  bool ReadFromTH2(const TH2* inHist_p);
+
+  Double_t GetBinContent(const Int_t replicaPos, const Int_t binPos) const;
+  Int_t GetNReplicas() const;
+
+ private:
+  Int_t m_nBins = 0;
+  Int_t m_nReplicas = 0;
+  std::vector<Double_t> m_binEdges;
+  std::vector<Double_t> m_sumw;
+  Double_t m_entries = 0.0;
+};
+
+bool bootstrapAccumulator::Init(const Int_t nBins, const Double_t* binEdges, const Int_t nReplicas)
+{
+  if(nBins <= 0 || nReplicas <= 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given nBins '" << nBins << "' + nReplicas '" << nReplicas << "' must be > 0. return false" << std::endl;
+    return false;
+  }
+
+  m_nBins = nBins;
+  m_nReplicas = nReplicas;
+  m_binEdges.assign(binEdges, binEdges + nBins + 1);
+
+  Reset();
+  return true;
+}
+
+void bootstrapAccumulator::Reset()
+{
+  m_sumw.assign(m_nBins*m_nReplicas, 0.0);
+  m_entries = 0.0;
+  return;
+}
+
+void bootstrapAccumulator::FillEvents(const Long64_t nEvents, const Long64_t* offsets, const Float_t* pt, const Float_t* eta, const Float_t absEtaMax, const Float_t ptMin, const Float_t ptMax, const Float_t* eventWeights, const UChar_t* replicaWeights)
+{
+  const Int_t nReplicas = m_nReplicas;
+  for(Long64_t eI = 0; eI < nEvents; ++eI){
+    const Double_t eventWeight = eventWeights == nullptr ? 1.0 : eventWeights[eI];
+    const UChar_t* eventReplicaWeights = replicaWeights + eI*nReplicas;
+
+    for(Long64_t jI = offsets[eI]; jI < offsets[eI+1]; ++jI){
+      const Float_t ptVal = pt[jI];
+      if(std::fabs(eta[jI]) > absEtaMax || ptVal < ptMin || ptVal >= ptMax) continue;
+
+      //binEdges[binPos] <= pt < binEdges[binPos+1], as spectrumAccumulator::CorrectBin
+      Int_t binPos = (Int_t)(std::upper_bound(m_binEdges.begin(), m_binEdges.end(), (Double_t)ptVal) - m_binEdges.begin()) - 1;
+      binPos = TMath::Max(0, TMath::Min(m_nBins - 1, binPos));
+
+      Double_t* binSumw = m_sumw.data() + binPos*nReplicas;
+      for(Int_t bI = 0; bI < nReplicas; ++bI){
+	binSumw[bI] += eventWeight*eventReplicaWeights[bI];
+      }
+      m_entries += 1.0;
+    }
+  }
+  return;
+}
+
+void bootstrapAccumulator::Add(const bootstrapAccumulator& inAcc, const Double_t scale)
+{
+  if(inAcc.m_nBins != m_nBins || inAcc.m_nReplicas != m_nReplicas){
+    std::cout << __PRETTY_FUNCTION__ << ": nBins, nReplicas mismatch, " << inAcc.m_nBins << ", " << inAcc.m_nReplicas << " vs. " << m_nBins << ", " << m_nReplicas << ". return" << std::endl;
+    return;
+  }
+
+  for(unsigned int sI = 0; sI < m_sumw.size(); ++sI){
+    m_sumw[sI] += scale*inAcc.m_sumw[sI];
+  }
+  m_entries += inAcc.m_entries;
+  return;
+}
+
+bool bootstrapAccumulator::WriteToTH2(TH2* inHist_p) const
+{
+  if(inHist_p->GetNbinsX() != m_nBins || inHist_p->GetNbinsY() != m_nReplicas){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << inHist_p->GetName() << "' has " << inHist_p->GetNbinsX() << "x" << inHist_p->GetNbinsY() << " bins, expected " << m_nBins << "x" << m_nReplicas << ". return false" << std::endl;
+    return false;
+  }
+
+  for(Int_t bI = 0; bI < m_nBins; ++bI){
+    for(Int_t rI = 0; rI < m_nReplicas; ++rI){
+      inHist_p->SetBinContent(bI+1, rI+1, m_sumw[bI*m_nReplicas + rI]);
+    }
+  }
+  inHist_p->SetEntries(m_entries);
+
+  return true;
+}
+
+bool bootstrapAccumulator::ReadFromTH2(const TH2* inHist_p)
+{
+  if(inHist_p->GetNbinsX() != m_nBins || inHist_p->GetNbinsY() != m_nReplicas){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << inHist_p->GetName() << "' has " << inHist_p->GetNbinsX() << "x" << inHist_p->GetNbinsY() << " bins, expected " << m_nBins << "x" << m_nReplicas << ". return false" << std::endl;
+    return false;
+  }
+
+  for(Int_t bI = 0; bI < m_nBins; ++bI){
+    for(Int_t rI = 0; rI < m_nReplicas; ++rI){
+      m_sumw[bI*m_nReplicas + rI] = inHist_p->GetBinContent(bI+1, rI+1);
+    }
+  }
+  m_entries = inHist_p->GetEntries();
+
+  return true;
+}
+
+Double_t bootstrapAccumulator::GetBinContent(const Int_t replicaPos, const Int_t binPos) const {return m_sumw[binPos*m_nReplicas + replicaPos];}
+Int_t bootstrapAccumulator::GetNReplicas() const {return m_nReplicas;}
+
+#endif
@@ -0,0 +1,80 @@
+//Fixed-capacity blocking FIFO between producer + consumer threads
+//Push blocks while full, so fast producers cannot run ahead of consumers w/o bound; Pop blocks while empty
+//Close() is called once all producers are done - Pop then drains what is left and returns false when empty
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+//c+cpp
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+template <typename T>
+class boundedQueue
+{
+ public:
+  boundedQueue(const unsigned int capacity);
+  ~boundedQueue(){};
+
+  //Returns false if the queue was already closed, item is then dropped
+  bool Push(T&& item);
+  //Returns false once the queue is closed + empty
+  bool Pop(T* outItem);
+  void Close();
+
+ private:
+  unsigned int m_capacity;
+  bool m_isClosed = false;
+  std::deque<T> m_items;
+  std::mutex m_mutex;
+  std::condition_variable m_notFull, m_notEmpty;
+};
+
+template <typename T>
+boundedQueue<T>::boundedQueue(const unsigned int capacity)
+{
+  m_capacity = capacity == 0 ? 1 : capacity;
+  return;
+}
+
+template <typename T>
+bool boundedQueue<T>::Push(T&& item)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_notFull.wait(lock, [this](){return m_isClosed || m_items.size() < m_capacity;});
+  if(m_isClosed) return false;
+
+  m_items.push_back(std::move(item));
+  lock.unlock();
+  m_notEmpty.notify_one();
+  return true;
+}
+
+template <typename T>
+bool boundedQueue<T>::Pop(T* outItem)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_notEmpty.wait(lock, [this](){return m_isClosed || !m_items.empty();});
+  if(m_items.empty()) return false;
+
+  *outItem = std::move(m_items.front());
+  m_items.pop_front();
+  lock.unlock();
+  m_notFull.notify_one();
+  return true;
+}
+
+template <typename T>
+void boundedQueue<T>::Close()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isClosed = true;
+  }
+  m_notFull.notify_all();
+  m_notEmpty.notify_all();
+  return;
+}
+
+#endif
@@ -0,0 +1,109 @@
+//Growable buffer for leaflist array branches, replacing fixed-size stack arrays (e.g. Float_t pt[10000])
+//Writers call Reserve(n) before filling n elements; on reallocation every bound branch gets the new address,
+//for writing (TTree::Branch) and reading (SetBranchAddress) alike, so the size is never silently exceeded
+//The high-water mark records the largest size requested, e.g. to report the busiest event of a job
+
+#ifndef BRANCHBUFFER_H
+#define BRANCHBUFFER_H
+
+//c+cpp
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TTree.h"
+
+template <typename T>
+class branchBuffer
+{
+ public:
+  branchBuffer(){};
+  branchBuffer(const ULong64_t initSize);
+  ~branchBuffer(){};
+
+  //Creates branchName in inTree_p w/ leafList, e.g. "pt[npart]/F", on this buffer
+  void Branch(TTree* inTree_p, const std::string branchName, const std::string leafList);
+  //Reads branchName of inTree_p into this buffer
+  void SetBranchAddress(TTree* inTree_p, const std::string branchName);
+
+  //Ensure room for nElements; returns true if the buffer was reallocated (+ branches re-bound)
+  bool Reserve(const ULong64_t nElements);
+
+  T* Data();
+  const T* Data() const;
+  T& operator[](const ULong64_t pos);
+  const T& operator[](const ULong64_t pos) const;
+
+  ULong64_t GetSize() const;
+  ULong64_t GetHighWaterMark() const;
+
+ private:
+  std::vector<T> m_data;
+  ULong64_t m_highWaterMark = 0;
+  std::vector<TTree*> m_trees;
+  std::vector<std::string> m_branchNames;
+};
+
+template <typename T>
+branchBuffer<T>::branchBuffer(const ULong64_t initSize)
+{
+  m_data.resize(initSize == 0 ? 1 : initSize);
+  return;
+}
+
+template <typename T>
+void branchBuffer<T>::Branch(TTree* inTree_p, const std::string branchName, const std::string leafList)
+{
+  if(m_data.size() == 0) m_data.resize(1);
+  inTree_p->Branch(branchName.c_str(), m_data.data(), leafList.c_str());
+  m_trees.push_back(inTree_p);
+  m_branchNames.push_back(branchName);
+  return;
+}
+
+template <typename T>
+void branchBuffer<T>::SetBranchAddress(TTree* inTree_p, const std::string branchName)
+{
+  if(m_data.size() == 0) m_data.resize(1);
+  inTree_p->SetBranchAddress(branchName.c_str(), m_data.data());
+  m_trees.push_back(inTree_p);
+  m_branchNames.push_back(branchName);
+  return;
+}
+
+template <typename T>
+bool branchBuffer<T>::Reserve(const ULong64_t nElements)
+{
+  if(nElements > m_highWaterMark) m_highWaterMark = nElements;
+  if(nElements <= m_data.size()) return false;
+
+  //Geometric growth so a slowly rising multiplicity does not rebind every event
+  ULong64_t newSize = 2*m_data.size();
+  if(newSize < nElements) newSize = nElements;
+  m_data.resize(newSize);
+
+  for(unsigned int bI = 0; bI < m_trees.size(); ++bI){
+    m_trees[bI]->SetBranchAddress(m_branchNames[bI].c_str(), m_data.data());
+  }
+  return true;
+}
+
+template <typename T>
+T* branchBuffer<T>::Data(){return m_data.data();}
+
+template <typename T>
+const T* branchBuffer<T>::Data() const {return m_data.data();}
+
+template <typename T>
+T& branchBuffer<T>::operator[](const ULong64_t pos){return m_data[pos];}
+
+template <typename T>
+const T& branchBuffer<T>::operator[](const ULong64_t pos) const {return m_data[pos];}
+
+template <typename T>
+ULong64_t branchBuffer<T>::GetSize() const {return m_data.size();}
+
+template <typename T>
+ULong64_t branchBuffer<T>::GetHighWaterMark() const {return m_highWaterMark;}
+
+#endif
@@ -0,0 +1,95 @@
+//Compact evtTree encoding (createPYTHIA DOCOMPACTEVTTREE)
+//pt, eta, phi as Float16_t: pt w/ a truncated mantissa of COMPACTPTBITS bits (fixed relative precision), eta + phi as
+//fixed-point over their full range w/ COMPACTETABITS, COMPACTPHIBITS bits; m + id are replaced by one UChar_t species code pcode
+//Readers see Float_t pt/eta/phi either way (ROOT expands Float16_t on read); m + id come back from the code table
+
+#ifndef COMPACTEVTTREEUTIL_H
+#define COMPACTEVTTREEUTIL_H
+
+//c+cpp
+#include <iostream>
+#include <string>
+
+//ROOT
+#include "TMath.h"
+#include "TString.h"
+
+//createPYTHIA keeps particles w/ |eta| <= 5.0, so the fixed-point eta range loses nothing
+const Float_t compactEvtAbsEtaMax = 5.0;
+//Truncated mantissa mode packs sign + mantissa in a UShort_t, so pt gets at most 14 bits; range mode stores a UInt_t
+//per value, capped at 16 bits since the compressed size grows w/ every bit
+const Int_t compactEvtMaxPtBits = 14;
+const Int_t compactEvtMaxAngleBits = 16;
+
+//Species code table: code = position + 1, code 0 is reserved for ids not in the table (read back as id 0, m 0)
+//Covers the PYTHIA final state w/ default decays + the weakly decaying hadrons, for runs w/ ParticleDecays:limitTau0 on
+struct particleCodeEntry
+{
+  Int_t id;
+  Float_t m;
+};
+
+const particleCodeEntry particleCodeTable[] = {
+  {22, 0.0},
+  {11, 0.000510999}, {-11, 0.000510999},
+  {13, 0.105658}, {-13, 0.105658},
+  {211, 0.139570}, {-211, 0.139570},
+  {321, 0.493677}, {-321, 0.493677},
+  {130, 0.497611}, {310, 0.497611},
+  {2212, 0.938272}, {-2212, 0.938272},
+  {2112, 0.939565}, {-2112, 0.939565},
+  {3122, 1.115683}, {-3122, 1.115683},
+  {3222, 1.189370}, {-3222, 1.189370},
+  {3112, 1.197449}, {-3112, 1.197449},
+  {3312, 1.321710}, {-3312, 1.321710},
+  {3322, 1.314860}, {-3322, 1.314860},
+  {3334, 1.672450}, {-3334, 1.672450}
+};
+const Int_t nParticleCodes = sizeof(particleCodeTable)/sizeof(particleCodeEntry);
+
+//Linear search, the table is short + the common ids are up front
+inline UChar_t getParticleCode(const Int_t id)
+{
+  for(Int_t cI = 0; cI < nParticleCodes; ++cI){
+    if(particleCodeTable[cI].id == id) return (UChar_t)(cI + 1);
+  }
+  return 0;
+}
+
+inline Int_t getParticleCodeId(const UChar_t code)
+{
+  if(code == 0 || code > nParticleCodes) return 0;
+  return particleCodeTable[code - 1].id;
+}
+
+inline Float_t getParticleCodeMass(const UChar_t code)
+{
+  if(code == 0 || code > nParticleCodes) return 0.0;
+  return particleCodeTable[code - 1].m;
+}
+
+inline bool checkCompactEvtBits(const Int_t ptBits, const Int_t etaBits, const Int_t phiBits)
+{
+  //Float16_t needs at least 2 bits, the ROOT minimum
+  if(ptBits < 2 || ptBits > compactEvtMaxPtBits){
+    std::cout << __PRETTY_FUNCTION__ << ": given COMPACTPTBITS '" << ptBits << "' must be in [2, " << compactEvtMaxPtBits << "]. return false" << std::endl;
+    return false;
+  }
+  if(etaBits < 2 || etaBits > compactEvtMaxAngleBits || phiBits < 2 || phiBits > compactEvtMaxAngleBits){
+    std::cout << __PRETTY_FUNCTION__ << ": given COMPACTETABITS '" << etaBits << "', COMPACTPHIBITS '" << phiBits << "' must be in [2, " << compactEvtMaxAngleBits << "]. return false" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//Float16_t leaflists for the compact evtTree, e.g. "pt[npart]/f[0,0,12]"; xmin = xmax = 0 selects the truncated mantissa mode
+inline std::string getCompactPtLeafList(const std::string countName, const Int_t nBits){return "pt[" + countName + "]/f[0,0," + std::to_string(nBits) + "]";}
+inline std::string getCompactEtaLeafList(const std::string countName, const Int_t nBits){return "eta[" + countName + "]/f[" + std::string(Form("%.1f,%.1f", -compactEvtAbsEtaMax, compactEvtAbsEtaMax)) + "," + std::to_string(nBits) + "]";}
+inline std::string getCompactPhiLeafList(const std::string countName, const Int_t nBits){return "phi[" + countName + "]/f[" + std::string(Form("%.6f,%.6f", -TMath::Pi(), TMath::Pi())) + "," + std::to_string(nBits) + "]";}
+
+//Worst-case absolute error of the fixed-point eta/phi encoding, and relative error of the truncated pt mantissa
+inline Double_t getCompactEtaPrecision(const Int_t nBits){return compactEvtAbsEtaMax/(1 << nBits);}
+inline Double_t getCompactPhiPrecision(const Int_t nBits){return TMath::Pi()/(1 << nBits);}
+inline Double_t getCompactPtPrecision(const Int_t nBits){return 1.0/(1 << (nBits + 1));}
+
+#endif
@@ -0,0 +1,178 @@
+//Per-event spatial index of jets in (eta, phi) for nearest-neighbour lookups within a fixed DeltaR
+//Cells are at least cellSize wide in eta + phi, so every jet within cellSize of a point is in the 3x3 cells around it;
+//phi cells wrap around, jets beyond |eta| absEtaMax share the outermost eta cells (still exact, only less selective)
+//Fill is a counting sort over the touched cells + Clear resets only those, so an event costs O(nJets) whatever the grid size
+//Events w/ at most maxDirectScanJets jets skip the index + are scanned directly, cheaper than binning so few
+
+#ifndef ETAPHIGRID_H
+#define ETAPHIGRID_H
+
+//c+cpp
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+
+//DeltaR^2 w/ phi wrapped into [0, pi]; phi in any 2pi range, e.g. FastJet [0, 2pi) or [-pi, pi)
+inline Double_t getDeltaR2(const Float_t eta1, const Float_t phi1, const Float_t eta2, const Float_t phi2)
+{
+  const Double_t dEta = eta1 - eta2;
+  Double_t dPhi = std::fabs((Double_t)phi1 - (Double_t)phi2);
+  if(dPhi > TMath::Pi()) dPhi = 2.0*TMath::Pi() - dPhi;
+  return dEta*dEta + dPhi*dPhi;
+}
+
+const Int_t maxDirectScanJets = 16;
+
+class etaPhiGrid
+{
+ public:
+  etaPhiGrid(){};
+  ~etaPhiGrid(){};
+
+  bool Init(const Float_t cellSize, const Float_t absEtaMax);
+  //Index jets [0, nJets) of eta/phi; the arrays must stay valid until Clear
+  void Fill(const Int_t nJets, const Float_t* eta, const Float_t* phi);
+  //Nearest indexed jet w/ DeltaR < maxDR (maxDR <= cellSize), lowest index on ties; -1 if none, else *outDR2 is its DeltaR^2
+  Int_t FindNearest(const Float_t eta, const Float_t phi, const Float_t maxDR, Double_t* outDR2) const;
+  void Clear();
+
+ private:
+  Float_t m_absEtaMax = 0.0;
+  Int_t m_nEtaCells = 0;
+  Int_t m_nPhiCells = 0;
+  Double_t m_etaInvWidth = 0.0;
+  Double_t m_phiInvWidth = 0.0;
+
+  const Float_t* m_eta_p = nullptr;
+  const Float_t* m_phi_p = nullptr;
+  Int_t m_nJets = 0;
+  //Per cell: jets + position of its first jet in m_cellJets, valid for touched cells only
+  std::vector<Int_t> m_cellCount, m_cellStart, m_cellFill;
+  std::vector<Int_t> m_cellJets, m_jetCell, m_touchedCells;
+
+  Int_t GetEtaCell(const Float_t eta) const;
+  Int_t GetPhiCell(const Float_t phi) const;
+};
+
+bool etaPhiGrid::Init(const Float_t cellSize, const Float_t absEtaMax)
+{
+  if(cellSize <= 0.0 || absEtaMax <= 0.0){
+    std::cout << __PRETTY_FUNCTION__ << ": given cellSize '" << cellSize << "' + absEtaMax '" << absEtaMax << "' must be > 0. return false" << std::endl;
+    return false;
+  }
+
+  //Rounded down, so cells are never narrower than cellSize
+  m_absEtaMax = absEtaMax;
+  m_nEtaCells = TMath::Max(1, (Int_t)(2.0*absEtaMax/cellSize));
+  m_nPhiCells = TMath::Max(1, (Int_t)(2.0*TMath::Pi()/cellSize));
+  m_etaInvWidth = m_nEtaCells/(2.0*absEtaMax);
+  m_phiInvWidth = m_nPhiCells/(2.0*TMath::Pi());
+
+  m_cellCount.assign(m_nEtaCells*m_nPhiCells, 0);
+  m_cellStart.assign(m_nEtaCells*m_nPhiCells, 0);
+  m_cellFill.assign(m_nEtaCells*m_nPhiCells, 0);
+  m_touchedCells.clear();
+  return true;
+}
+
+Int_t etaPhiGrid::GetEtaCell(const Float_t eta) const
+{
+  const Int_t etaCell = (Int_t)std::floor((eta + m_absEtaMax)*m_etaInvWidth);
+  return TMath::Max(0, TMath::Min(m_nEtaCells - 1, etaCell));
+}
+
+Int_t etaPhiGrid::GetPhiCell(const Float_t phi) const
+{
+  Double_t phiShift = phi + TMath::Pi();
+  phiShift -= 2.0*TMath::Pi()*std::floor(phiShift/(2.0*TMath::Pi()));
+  return TMath::Min(m_nPhiCells - 1, (Int_t)(phiShift*m_phiInvWidth));
+}
+
+void etaPhiGrid::Fill(const Int_t nJets, const Float_t* eta, const Float_t* phi)
+{
+  m_eta_p = eta;
+  m_phi_p = phi;
+  m_nJets = nJets;
+  if(nJets <= maxDirectScanJets) return;
+
+  m_jetCell.resize(nJets);
+  m_cellJets.resize(nJets);
+
+  for(Int_t jI = 0; jI < nJets; ++jI){
+    const Int_t cellPos = GetEtaCell(eta[jI])*m_nPhiCells + GetPhiCell(phi[jI]);
+    m_jetCell[jI] = cellPos;
+    if(m_cellCount[cellPos]++ == 0) m_touchedCells.push_back(cellPos);
+  }
+
+  Int_t cellStart = 0;
+  for(unsigned int tI = 0; tI < m_touchedCells.size(); ++tI){
+    const Int_t cellPos = m_touchedCells[tI];
+    m_cellStart[cellPos] = cellStart;
+    m_cellFill[cellPos] = cellStart;
+    cellStart += m_cellCount[cellPos];
+  }
+
+  //Jets stay in index order within a cell
+  for(Int_t jI = 0; jI < nJets; ++jI){
+    m_cellJets[m_cellFill[m_jetCell[jI]]++] = jI;
+  }
+  return;
+}
+
+Int_t etaPhiGrid::FindNearest(const Float_t eta, const Float_t phi, const Float_t maxDR, Double_t* outDR2) const
+{
+  Int_t nearestPos = -1;
+  Double_t nearestDR2 = (Double_t)maxDR*(Double_t)maxDR;
+  if(m_nJets <= maxDirectScanJets){
+    for(Int_t jI = 0; jI < m_nJets; ++jI){
+      const Double_t dR2 = getDeltaR2(eta, phi, m_eta_p[jI], m_phi_p[jI]);
+      if(dR2 < nearestDR2){
+	nearestDR2 = dR2;
+	nearestPos = jI;
+      }
+    }
+    if(nearestPos >= 0) *outDR2 = nearestDR2;
+    return nearestPos;
+  }
+
+  const Int_t etaCell = GetEtaCell(eta);
+  const Int_t phiCell = GetPhiCell(phi);
+  //W/ fewer than 3 phi cells the neighbours wrap onto each other; visit each once
+  const Int_t phiLow = m_nPhiCells < 3 ? 0 : phiCell - 1;
+  const Int_t phiHigh = m_nPhiCells < 3 ? m_nPhiCells - 1 : phiCell + 1;
+
+  for(Int_t eI = TMath::Max(0, etaCell - 1); eI <= TMath::Min(m_nEtaCells - 1, etaCell + 1); ++eI){
+    for(Int_t pI = phiLow; pI <= phiHigh; ++pI){
+      const Int_t cellPos = eI*m_nPhiCells + (pI + m_nPhiCells)%m_nPhiCells;
+      const Int_t nCellJets = m_cellCount[cellPos];
+      for(Int_t cI = 0; cI < nCellJets; ++cI){
+	const Int_t jetPos = m_cellJets[m_cellStart[cellPos] + cI];
+	const Double_t dR2 = getDeltaR2(eta, phi, m_eta_p[jetPos], m_phi_p[jetPos]);
+	if(dR2 < nearestDR2 || (dR2 == nearestDR2 && nearestPos >= 0 && jetPos < nearestPos)){
+	  nearestDR2 = dR2;
+	  nearestPos = jetPos;
+	}
+      }
+    }
+  }
+
+  if(nearestPos >= 0) *outDR2 = nearestDR2;
+  return nearestPos;
+}
+
+void etaPhiGrid::Clear()
+{
+  for(unsigned int tI = 0; tI < m_touchedCells.size(); ++tI){
+    m_cellCount[m_touchedCells[tI]] = 0;
+  }
+  m_touchedCells.clear();
+  m_eta_p = nullptr;
+  m_phi_p = nullptr;
+  m_nJets = 0;
+  return;
+}
+
+#endif
@@ -0,0 +1,69 @@
+//Stage timing + throughput instrumentation, sibling of globalDebugHandler
+//Switched on by environment variable DOGLOBALTIMINGROOT=1; when off every call returns immediately
+
+#ifndef GLOBALTIMINGHANDLER_H
+#define GLOBALTIMINGHANDLER_H
+
+//cpp
+#include <chrono>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TEnv.h"
+#include "TFile.h"
+
+class globalTimingHandler
+{
+ public:
+  globalTimingHandler();
+  ~globalTimingHandler(){};
+
+  bool GetDoGlobalTiming() const;
+
+  //Index of stage stageName, registered on first call - look up once outside of the event loop
+  Int_t GetStageIndex(const std::string stageName);
+  //Wall + CPU time of the calling thread between Start and Stop, summed over calls
+  void StartStage(const Int_t stageIndex);
+  void StopStage(const Int_t stageIndex);
+  void AddEvents(const Long64_t nEvents);
+
+  //Add the stages (matched by name) + events of a handler filled on another thread, or of a summary written by one
+  void Add(const globalTimingHandler& inHandler);
+  bool Add(TEnv* inSummary_p);
+
+  //Per-stage wall/CPU time, calls, events/sec over the handler lifetime and peak RSS of the process
+  void Print(const std::string label) const;
+  void FillSummary(TEnv* outSummary_p) const;
+  void Write(TFile* outFile_p, const std::string summaryName) const;
+
+ private:
+  const std::string envVarStr = "DOGLOBALTIMINGROOT";
+  bool m_doGlobalTiming;
+
+  std::chrono::steady_clock::time_point m_initTime;
+  Long64_t m_nEvents = 0;
+
+  std::vector<std::string> m_stageNames;
+  std::vector<Double_t> m_stageWallSec, m_stageCPUSec;
+  std::vector<Long64_t> m_stageNCalls;
+  std::vector<std::chrono::steady_clock::time_point> m_stageWallStart;
+  std::vector<Double_t> m_stageCPUStart;
+
+  Double_t GetWallSec() const;
+  void AddStage(const std::string stageName, const Double_t wallSec, const Double_t cpuSec, const Long64_t nCalls);
+};
+
+//Times its scope as one call of the given stage
+class globalTimingScope
+{
+ public:
+  globalTimingScope(globalTimingHandler* inHandler_p, const Int_t stageIndex);
+  ~globalTimingScope();
+
+ private:
+  globalTimingHandler* m_handler_p;
+  Int_t m_stageIndex;
+};
+
+#endif
@@ -0,0 +1,321 @@
+//Flat jet cache sidecar (createJetSpectraAndShapes DOJETCACHE)
+//One-time conversion of a createPYTHIA jetTree into a raw binary file: a fixed header, then per R the event offsets and the
+//pt/eta/phi columns (structure-of-arrays, as jetColumnBlock), the per-event event numbers + the weights of pthat-binned input
+//Read through a read-only mmap, so a scan costs page faults + memory bandwidth - no decompression, no copy
+//Native byte order + struct layout: a local cache, not a portable format. The source identity (TFile UUID, entries, R values,
+//weighted or not) is stored + checked on open, so a stale cache is rebuilt rather than read
+
+#ifndef JETCACHEUTIL_H
+#define JETCACHEUTIL_H
+
+//c+cpp
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//POSIX - mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//ROOT
+#include "TFile.h"
+#include "TMath.h"
+#include "TTree.h"
+
+//local
+#include "include/jetTreeBatchReader.h"
+
+const char jetCacheMagic[8] = {'J', 'T', 'C', 'A', 'C', 'H', 'E', '\0'};
+//Version 2 adds the evtnum column; older caches fail the version check + are rebuilt
+const Int_t jetCacheVersion = 2;
+const Int_t jetCacheMaxNR = 32;
+//Every column starts on a cache line
+const Long64_t jetCacheAlign = 64;
+
+//Positions are byte offsets from the start of the file; offsets[rI] has nEntries + 1 Long64_t, event e owning jets
+//[offsets[e], offsets[e+1]) of the nJets[rI] Float_t pt/eta/phi; evtnum has nEntries ULong64_t, weights nEntries Float_t if hasWeight
+struct jetCacheHeader
+{
+  char magic[8];
+  Int_t version;
+  Int_t nR;
+  Long64_t nEntries;
+  Int_t hasWeight;
+  Int_t padding;
+  char sourceUUID[48];
+  Float_t rVals[jetCacheMaxNR];
+  Long64_t nJets[jetCacheMaxNR];
+  Long64_t offsetsPos[jetCacheMaxNR];
+  Long64_t ptPos[jetCacheMaxNR];
+  Long64_t etaPos[jetCacheMaxNR];
+  Long64_t phiPos[jetCacheMaxNR];
+  Long64_t evtNumPos;
+  Long64_t weightPos;
+  Long64_t fileSize;
+};
+
+inline Long64_t getJetCacheAligned(const Long64_t pos){return ((pos + jetCacheAlign - 1)/jetCacheAlign)*jetCacheAlign;}
+
+//Sidecar of inFileName, next to it if cacheDir is empty
+inline std::string getJetCacheName(const std::string inFileName, const std::string cacheDir)
+{
+  std::string cacheName = inFileName;
+  if(cacheDir.size() != 0){
+    if(cacheName.find("/") != std::string::npos) cacheName.replace(0, cacheName.rfind("/") + 1, "");
+    cacheName = cacheDir + "/" + cacheName;
+  }
+  return cacheName + ".jtcache";
+}
+
+//Converts the jetTree of inFileName into cacheFileName; written under a temporary name + renamed when complete, so an
+//interrupted conversion never leaves a cache that looks valid
+inline bool buildJetCache(const std::string inFileName, const std::string cacheFileName, const std::vector<float>& rParams, const Long64_t batchSize)
+{
+  const Int_t nR = (Int_t)rParams.size();
+  if(nR < 1 || nR > jetCacheMaxNR){
+    std::cout << __PRETTY_FUNCTION__ << ": given " << nR << " R values, must be in [1, " << jetCacheMaxNR << "]. return false" << std::endl;
+    return false;
+  }
+
+  TFile* inFile_p = new TFile(inFileName.c_str(), "READ");
+  TTree* jetTree_p = (TTree*)inFile_p->Get("jetTree");
+  if(jetTree_p == nullptr){
+    std::cout << __PRETTY_FUNCTION__ << ": jetTree not found in '" << inFileName << "'. return false" << std::endl;
+    inFile_p->Close();
+    delete inFile_p;
+    return false;
+  }
+  const Long64_t nEntries = jetTree_p->GetEntries();
+
+  jetCacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, jetCacheMagic, sizeof(header.magic));
+  header.version = jetCacheVersion;
+  header.nR = nR;
+  header.nEntries = nEntries;
+  header.hasWeight = jetTree_p->GetBranch("weight") != nullptr;
+  std::strncpy(header.sourceUUID, inFile_p->GetUUID().AsString(), sizeof(header.sourceUUID) - 1);
+
+  //Column sizes first, from the njt branches alone
+  std::vector<Int_t> njt(nR, 0);
+  jetTree_p->SetBranchStatus("*", 0);
+  for(Int_t rI = 0; rI < nR; ++rI){
+    std::string rStr = Form("R%.1f", rParams[rI]);
+    rStr.replace(rStr.find("."), 1, "p");
+    const std::string nRStr = "njt" + rStr;
+    if(jetTree_p->GetBranch(nRStr.c_str()) == nullptr){
+      std::cout << __PRETTY_FUNCTION__ << ": branch '" << nRStr << "' not found in jetTree of '" << inFileName << "'. return false" << std::endl;
+      inFile_p->Close();
+      delete inFile_p;
+      return false;
+    }
+    jetTree_p->SetBranchStatus(nRStr.c_str(), 1);
+    jetTree_p->SetBranchAddress(nRStr.c_str(), &(njt[rI]));
+    header.rVals[rI] = rParams[rI];
+  }
+  for(Long64_t entry = 0; entry < nEntries; ++entry){
+    jetTree_p->GetEntry(entry);
+    for(Int_t rI = 0; rI < nR; ++rI){
+      header.nJets[rI] += njt[rI];
+    }
+  }
+  jetTree_p->ResetBranchAddresses();
+
+  Long64_t pos = getJetCacheAligned(sizeof(header));
+  for(Int_t rI = 0; rI < nR; ++rI){
+    header.offsetsPos[rI] = pos;
+    pos = getJetCacheAligned(pos + (nEntries + 1)*(Long64_t)sizeof(Long64_t));
+    header.ptPos[rI] = pos;
+    pos = getJetCacheAligned(pos + header.nJets[rI]*(Long64_t)sizeof(Float_t));
+    header.etaPos[rI] = pos;
+    pos = getJetCacheAligned(pos + header.nJets[rI]*(Long64_t)sizeof(Float_t));
+    header.phiPos[rI] = pos;
+    pos = getJetCacheAligned(pos + header.nJets[rI]*(Long64_t)sizeof(Float_t));
+  }
+  header.evtNumPos = pos;
+  pos = getJetCacheAligned(pos + nEntries*(Long64_t)sizeof(ULong64_t));
+  header.weightPos = pos;
+  if(header.hasWeight) pos += nEntries*(Long64_t)sizeof(Float_t);
+  header.fileSize = pos;
+
+  const std::string tempFileName = cacheFileName + ".tmp";
+  std::ofstream outFile(tempFileName.c_str(), std::ios::binary | std::ios::trunc);
+  if(!outFile.is_open()){
+    std::cout << __PRETTY_FUNCTION__ << ": cannot create '" << tempFileName << "'. return false" << std::endl;
+    inFile_p->Close();
+    delete inFile_p;
+    return false;
+  }
+  outFile.write((const char*)&header, sizeof(header));
+
+  //Blocks as createJetSpectraAndShapes reads them; each column is written at its running position
+  jetTreeBatchReader batchReader;
+  bool isGood = batchReader.Init(jetTree_p, rParams, 0, nEntries);
+  std::vector<Long64_t> nJetsDone(nR, 0);
+  jetColumnBlock block;
+  for(Long64_t blockStart = 0; isGood && blockStart < nEntries; blockStart += batchSize){
+    isGood = batchReader.ReadBlock(blockStart, batchSize, &block);
+    if(!isGood) break;
+
+    for(Int_t rI = 0; rI < nR; ++rI){
+      const Long64_t nBlockJets = block.pt[rI].size();
+      if(nJetsDone[rI] + nBlockJets > header.nJets[rI]){
+	isGood = false;
+	break;
+      }
+
+      //Block offsets start at 0, the cache ones at the jets of all earlier events
+      std::vector<Long64_t> offsets(block.offsets[rI].begin(), block.offsets[rI].end() - 1);
+      for(unsigned int eI = 0; eI < offsets.size(); ++eI){
+	offsets[eI] += nJetsDone[rI];
+      }
+      outFile.seekp(header.offsetsPos[rI] + blockStart*(Long64_t)sizeof(Long64_t));
+      outFile.write((const char*)offsets.data(), offsets.size()*sizeof(Long64_t));
+
+      outFile.seekp(header.ptPos[rI] + nJetsDone[rI]*(Long64_t)sizeof(Float_t));
+      outFile.write((const char*)block.pt[rI].data(), nBlockJets*sizeof(Float_t));
+      outFile.seekp(header.etaPos[rI] + nJetsDone[rI]*(Long64_t)sizeof(Float_t));
+      outFile.write((const char*)block.eta[rI].data(), nBlockJets*sizeof(Float_t));
+      outFile.seekp(header.phiPos[rI] + nJetsDone[rI]*(Long64_t)sizeof(Float_t));
+      outFile.write((const char*)block.phi[rI].data(), nBlockJets*sizeof(Float_t));
+      nJetsDone[rI] += nBlockJets;
+    }
+    outFile.seekp(header.evtNumPos + blockStart*(Long64_t)sizeof(ULong64_t));
+    outFile.write((const char*)block.evtnum.data(), block.evtnum.size()*sizeof(ULong64_t));
+    if(header.hasWeight){
+      outFile.seekp(header.weightPos + blockStart*(Long64_t)sizeof(Float_t));
+      outFile.write((const char*)block.weight.data(), block.weight.size()*sizeof(Float_t));
+    }
+  }
+  //Closing offset of every R
+  for(Int_t rI = 0; isGood && rI < nR; ++rI){
+    isGood = nJetsDone[rI] == header.nJets[rI];
+    outFile.seekp(header.offsetsPos[rI] + nEntries*(Long64_t)sizeof(Long64_t));
+    outFile.write((const char*)&(nJetsDone[rI]), sizeof(Long64_t));
+  }
+  isGood = isGood && outFile.good();
+  outFile.close();
+  //Trailing alignment padding is never written; fix the size so the open check on fileSize holds
+  if(isGood) isGood = truncate(tempFileName.c_str(), header.fileSize) == 0;
+
+  inFile_p->Close();
+  delete inFile_p;
+
+  if(!isGood){
+    std::cout << __PRETTY_FUNCTION__ << ": conversion of '" << inFileName << "' to '" << tempFileName << "' failed. return false" << std::endl;
+    std::remove(tempFileName.c_str());
+    return false;
+  }
+  if(std::rename(tempFileName.c_str(), cacheFileName.c_str()) != 0){
+    std::cout << __PRETTY_FUNCTION__ << ": cannot rename '" << tempFileName << "' to '" << cacheFileName << "'. return false" << std::endl;
+    std::remove(tempFileName.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+//Read-only view of a jet cache; pointers stay valid until Close, and are safe to share between threads
+class jetCacheReader
+{
+ public:
+  jetCacheReader(){};
+  ~jetCacheReader();
+
+  //Maps cacheFileName; false if it is truncated, of another version or not built from the given source
+  bool Open(const std::string cacheFileName, const std::string sourceUUID, const Long64_t sourceNEntries, const std::vector<float>& rParams, const bool isWeighted);
+  void Close();
+
+  Long64_t GetNEntries() const;
+  //Event offsets (nEntries + 1) + jet columns of R index rI
+  const Long64_t* GetOffsets(const Int_t rI) const;
+  const Float_t* GetPt(const Int_t rI) const;
+  const Float_t* GetEta(const Int_t rI) const;
+  const Float_t* GetPhi(const Int_t rI) const;
+  //Per-event event numbers, as jetColumnBlock::evtnum
+  const ULong64_t* GetEvtNum() const;
+  //Per-event weights, nullptr for unweighted input
+  const Float_t* GetWeights() const;
+
+ private:
+  int m_fd = -1;
+  char* m_map_p = nullptr;
+  Long64_t m_mapSize = 0;
+  const jetCacheHeader* m_header_p = nullptr;
+};
+
+jetCacheReader::~jetCacheReader(){Close();}
+
+bool jetCacheReader::Open(const std::string cacheFileName, const std::string sourceUUID, const Long64_t sourceNEntries, const std::vector<float>& rParams, const bool isWeighted)
+{
+  Close();
+
+  m_fd = open(cacheFileName.c_str(), O_RDONLY);
+  if(m_fd < 0){
+    std::cout << __PRETTY_FUNCTION__ << ": cannot open '" << cacheFileName << "'. return false" << std::endl;
+    return false;
+  }
+  struct stat fileStat;
+  if(fstat(m_fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(jetCacheHeader)){
+    std::cout << __PRETTY_FUNCTION__ << ": '" << cacheFileName << "' is shorter than a jet cache header. return false" << std::endl;
+    Close();
+    return false;
+  }
+  m_mapSize = fileStat.st_size;
+  void* map_p = mmap(nullptr, m_mapSize, PROT_READ, MAP_SHARED, m_fd, 0);
+  if(map_p == MAP_FAILED){
+    std::cout << __PRETTY_FUNCTION__ << ": mmap of '" << cacheFileName << "' failed. return false" << std::endl;
+    m_mapSize = 0;
+    Close();
+    return false;
+  }
+  m_map_p = (char*)map_p;
+  //Columns are scanned front to back
+  madvise(m_map_p, m_mapSize, MADV_SEQUENTIAL);
+  m_header_p = (const jetCacheHeader*)m_map_p;
+
+  bool isValid = std::memcmp(m_header_p->magic, jetCacheMagic, sizeof(jetCacheMagic)) == 0 && m_header_p->version == jetCacheVersion && m_header_p->fileSize == m_mapSize;
+  if(!isValid){
+    std::cout << __PRETTY_FUNCTION__ << ": '" << cacheFileName << "' is not a complete version " << jetCacheVersion << " jet cache. return false" << std::endl;
+    Close();
+    return false;
+  }
+
+  isValid = std::strncmp(m_header_p->sourceUUID, sourceUUID.c_str(), sizeof(m_header_p->sourceUUID)) == 0 && m_header_p->nEntries == sourceNEntries && m_header_p->nR == (Int_t)rParams.size() && (bool)m_header_p->hasWeight == isWeighted;
+  for(Int_t rI = 0; isValid && rI < m_header_p->nR; ++rI){
+    isValid = m_header_p->rVals[rI] == rParams[rI];
+  }
+  if(!isValid){
+    std::cout << __PRETTY_FUNCTION__ << ": '" << cacheFileName << "' was built from another version of its source (UUID, entries, R values or weights differ). return false" << std::endl;
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void jetCacheReader::Close()
+{
+  if(m_map_p != nullptr) munmap(m_map_p, m_mapSize);
+  if(m_fd >= 0) close(m_fd);
+  m_fd = -1;
+  m_map_p = nullptr;
+  m_mapSize = 0;
+  m_header_p = nullptr;
+  return;
+}
+
+Long64_t jetCacheReader::GetNEntries() const {return m_header_p->nEntries;}
+const Long64_t* jetCacheReader::GetOffsets(const Int_t rI) const {return (const Long64_t*)(m_map_p + m_header_p->offsetsPos[rI]);}
+const Float_t* jetCacheReader::GetPt(const Int_t rI) const {return (const Float_t*)(m_map_p + m_header_p->ptPos[rI]);}
+const Float_t* jetCacheReader::GetEta(const Int_t rI) const {return (const Float_t*)(m_map_p + m_header_p->etaPos[rI]);}
+const Float_t* jetCacheReader::GetPhi(const Int_t rI) const {return (const Float_t*)(m_map_p + m_header_p->phiPos[rI]);}
+const ULong64_t* jetCacheReader::GetEvtNum() const {return (const ULong64_t*)(m_map_p + m_header_p->evtNumPos);}
+const Float_t* jetCacheReader::GetWeights() const {return m_header_p->hasWeight ? (const Float_t*)(m_map_p + m_header_p->weightPos) : nullptr;}
+
+#endif
@@ -0,0 +1,270 @@
+//Reader for the constituent links written by createPYTHIA w/ DOJTCONSTITUENTS
+//jetTree: per R njt, jtpt/jteta/jtphi, jtnconst + jtconstbegin per jet, and nconst/constidx, the flat list of particle indices
+//evtTree (optional): the particle arrays the indices point into; a compact evtTree (DOCOMPACTEVTTREE) has its pcode
+//decoded into m + id on read, so views look the same for either layout
+//GetJetConstituents returns a view pointing straight into the read buffers - no copy, valid until the next GetEntry
+
+#ifndef JETCONSTITUENTVIEW_H
+#define JETCONSTITUENTVIEW_H
+
+//c+cpp
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TMath.h"
+#include "TTree.h"
+
+//local
+#include "include/compactEvtTreeUtil.h"
+
+struct jetConstituentView
+{
+  Int_t nConst = 0;
+  const UShort_t* partIndices = nullptr;
+  //Event particle arrays, nullptr if no evtTree was given
+  const Float_t* partPt = nullptr;
+  const Float_t* partEta = nullptr;
+  const Float_t* partPhi = nullptr;
+  const Float_t* partM = nullptr;
+  const Int_t* partId = nullptr;
+
+  Int_t GetN() const {return nConst;}
+  Int_t GetIndex(const Int_t cI) const {return partIndices[cI];}
+  Float_t GetPt(const Int_t cI) const {return partPt[partIndices[cI]];}
+  Float_t GetEta(const Int_t cI) const {return partEta[partIndices[cI]];}
+  Float_t GetPhi(const Int_t cI) const {return partPhi[partIndices[cI]];}
+  Float_t GetM(const Int_t cI) const {return partM[partIndices[cI]];}
+  Int_t GetId(const Int_t cI) const {return partId[partIndices[cI]];}
+};
+
+class jetConstituentReader
+{
+ public:
+  jetConstituentReader(){};
+  ~jetConstituentReader(){};
+
+  //evtTree_p may be nullptr if only the indices are needed
+  bool Init(TTree* jetTree_p, TTree* evtTree_p, std::vector<float> rParams);
+  bool GetEntry(const Long64_t entry);
+
+  Int_t GetNJet(const Int_t rI) const;
+  Float_t GetJetPt(const Int_t rI, const Int_t jI) const;
+  Float_t GetJetEta(const Int_t rI, const Int_t jI) const;
+  Float_t GetJetPhi(const Int_t rI, const Int_t jI) const;
+  jetConstituentView GetJetConstituents(const Int_t rI, const Int_t jI) const;
+
+ private:
+  TTree* m_jetTree_p = nullptr;
+  TTree* m_evtTree_p = nullptr;
+  Int_t m_nR = 0;
+
+  std::vector<TBranch*> m_njtBranches, m_nconstBranches;
+  std::vector<Int_t> m_njt, m_nconst;
+  std::vector<std::vector<Float_t> > m_jtpt, m_jteta, m_jtphi;
+  std::vector<std::vector<Int_t> > m_jtnconst;
+  std::vector<std::vector<UShort_t> > m_jtconstbegin, m_constidx;
+
+  TBranch* m_npartBranch_p = nullptr;
+  Int_t m_npart = 0;
+  bool m_isCompactEvtTree = false;
+  std::vector<Float_t> m_pt, m_eta, m_phi, m_m;
+  std::vector<Int_t> m_id;
+  std::vector<UChar_t> m_pcode;
+
+  void SetJetAddresses(const Int_t rI);
+  void SetConstAddresses(const Int_t rI);
+  void SetPartAddresses();
+};
+
+bool jetConstituentReader::Init(TTree* jetTree_p, TTree* evtTree_p, std::vector<float> rParams)
+{
+  m_jetTree_p = jetTree_p;
+  m_evtTree_p = evtTree_p;
+  m_nR = (Int_t)rParams.size();
+  m_njtBranches.assign(m_nR, nullptr);
+  m_nconstBranches.assign(m_nR, nullptr);
+  m_njt.assign(m_nR, 0);
+  m_nconst.assign(m_nR, 0);
+  m_jtpt.assign(m_nR, {});
+  m_jteta.assign(m_nR, {});
+  m_jtphi.assign(m_nR, {});
+  m_jtnconst.assign(m_nR, {});
+  m_jtconstbegin.assign(m_nR, {});
+  m_constidx.assign(m_nR, {});
+
+  m_jetTree_p->SetBranchStatus("*", 0);
+  for(Int_t rI = 0; rI < m_nR; ++rI){
+    std::string rStr = Form("R%.1f", rParams[rI]);
+    rStr.replace(rStr.find("."), 1, "p");
+
+    std::vector<std::string> branchNames = {"njt" + rStr, "jtpt" + rStr, "jteta" + rStr, "jtphi" + rStr, "jtnconst" + rStr, "jtconstbegin" + rStr, "nconst" + rStr, "constidx" + rStr};
+    for(unsigned int bI = 0; bI < branchNames.size(); ++bI){
+      if(m_jetTree_p->GetBranch(branchNames[bI].c_str()) == nullptr){
+	std::cout << __PRETTY_FUNCTION__ << ": branch '" << branchNames[bI] << "' not found in tree '" << m_jetTree_p->GetName() << "' (createPYTHIA w/ DOJTCONSTITUENTS: 1?). return false" << std::endl;
+	return false;
+      }
+      m_jetTree_p->SetBranchStatus(branchNames[bI].c_str(), 1);
+    }
+
+    m_njtBranches[rI] = m_jetTree_p->GetBranch(("njt" + rStr).c_str());
+    m_njtBranches[rI]->SetAddress(&(m_njt[rI]));
+    m_nconstBranches[rI] = m_jetTree_p->GetBranch(("nconst" + rStr).c_str());
+    m_nconstBranches[rI]->SetAddress(&(m_nconst[rI]));
+
+    //Start from the largest count written, grow in GetEntry if ever needed
+    TLeaf* njtLeaf_p = m_jetTree_p->GetLeaf(("njt" + rStr).c_str());
+    TLeaf* nconstLeaf_p = m_jetTree_p->GetLeaf(("nconst" + rStr).c_str());
+    const Int_t maxNJt = TMath::Max(1, njtLeaf_p == nullptr ? 1 : njtLeaf_p->GetMaximum());
+    const Int_t maxNConst = TMath::Max(1, nconstLeaf_p == nullptr ? 1 : nconstLeaf_p->GetMaximum());
+
+    m_jtpt[rI].resize(maxNJt);
+    m_jteta[rI].resize(maxNJt);
+    m_jtphi[rI].resize(maxNJt);
+    m_jtnconst[rI].resize(maxNJt);
+    m_jtconstbegin[rI].resize(maxNJt);
+    m_constidx[rI].resize(maxNConst);
+    SetJetAddresses(rI);
+    SetConstAddresses(rI);
+  }
+
+  if(m_evtTree_p != nullptr){
+    m_isCompactEvtTree = m_evtTree_p->GetBranch("pcode") != nullptr;
+    std::vector<std::string> branchNames = {"npart", "pt", "eta", "phi", "m", "id"};
+    if(m_isCompactEvtTree) branchNames = {"npart", "pt", "eta", "phi", "pcode"};
+    m_evtTree_p->SetBranchStatus("*", 0);
+    for(unsigned int bI = 0; bI < branchNames.size(); ++bI){
+      if(m_evtTree_p->GetBranch(branchNames[bI].c_str()) == nullptr){
+	std::cout << __PRETTY_FUNCTION__ << ": branch '" << branchNames[bI] << "' not found in tree '" << m_evtTree_p->GetName() << "'. return false" << std::endl;
+	return false;
+      }
+      m_evtTree_p->SetBranchStatus(branchNames[bI].c_str(), 1);
+    }
+
+    m_npartBranch_p = m_evtTree_p->GetBranch("npart");
+    m_npartBranch_p->SetAddress(&m_npart);
+
+    TLeaf* npartLeaf_p = m_evtTree_p->GetLeaf("npart");
+    const Int_t maxNPart = TMath::Max(1, npartLeaf_p == nullptr ? 1 : npartLeaf_p->GetMaximum());
+    m_pt.resize(maxNPart);
+    m_eta.resize(maxNPart);
+    m_phi.resize(maxNPart);
+    m_m.resize(maxNPart);
+    m_id.resize(maxNPart);
+    m_pcode.resize(maxNPart);
+    SetPartAddresses();
+  }
+
+  return true;
+}
+
+void jetConstituentReader::SetJetAddresses(const Int_t rI)
+{
+  std::string rStr = m_njtBranches[rI]->GetName();
+  rStr.replace(0, std::string("njt").size(), "");
+
+  m_jetTree_p->SetBranchAddress(("jtpt" + rStr).c_str(), m_jtpt[rI].data());
+  m_jetTree_p->SetBranchAddress(("jteta" + rStr).c_str(), m_jteta[rI].data());
+  m_jetTree_p->SetBranchAddress(("jtphi" + rStr).c_str(), m_jtphi[rI].data());
+  m_jetTree_p->SetBranchAddress(("jtnconst" + rStr).c_str(), m_jtnconst[rI].data());
+  m_jetTree_p->SetBranchAddress(("jtconstbegin" + rStr).c_str(), m_jtconstbegin[rI].data());
+  return;
+}
+
+void jetConstituentReader::SetConstAddresses(const Int_t rI)
+{
+  std::string rStr = m_nconstBranches[rI]->GetName();
+  rStr.replace(0, std::string("nconst").size(), "");
+
+  m_jetTree_p->SetBranchAddress(("constidx" + rStr).c_str(), m_constidx[rI].data());
+  return;
+}
+
+void jetConstituentReader::SetPartAddresses()
+{
+  m_evtTree_p->SetBranchAddress("pt", m_pt.data());
+  m_evtTree_p->SetBranchAddress("eta", m_eta.data());
+  m_evtTree_p->SetBranchAddress("phi", m_phi.data());
+  if(m_isCompactEvtTree) m_evtTree_p->SetBranchAddress("pcode", m_pcode.data());
+  else{
+    m_evtTree_p->SetBranchAddress("m", m_m.data());
+    m_evtTree_p->SetBranchAddress("id", m_id.data());
+  }
+  return;
+}
+
+bool jetConstituentReader::GetEntry(const Long64_t entry)
+{
+  if(m_jetTree_p == nullptr){
+    std::cout << __PRETTY_FUNCTION__ << ": reader not initialized. return false" << std::endl;
+    return false;
+  }
+
+  //Counts first, so buffers can grow before the arrays are read into them
+  for(Int_t rI = 0; rI < m_nR; ++rI){
+    m_njtBranches[rI]->GetEntry(entry);
+    m_nconstBranches[rI]->GetEntry(entry);
+
+    if(m_njt[rI] > (Int_t)m_jtpt[rI].size()){
+      m_jtpt[rI].resize(m_njt[rI]);
+      m_jteta[rI].resize(m_njt[rI]);
+      m_jtphi[rI].resize(m_njt[rI]);
+      m_jtnconst[rI].resize(m_njt[rI]);
+      m_jtconstbegin[rI].resize(m_njt[rI]);
+      SetJetAddresses(rI);
+    }
+    if(m_nconst[rI] > (Int_t)m_constidx[rI].size()){
+      m_constidx[rI].resize(m_nconst[rI]);
+      SetConstAddresses(rI);
+    }
+  }
+  if(m_jetTree_p->GetEntry(entry) <= 0) return false;
+
+  if(m_evtTree_p != nullptr){
+    m_npartBranch_p->GetEntry(entry);
+    if(m_npart > (Int_t)m_pt.size()){
+      m_pt.resize(m_npart);
+      m_eta.resize(m_npart);
+      m_phi.resize(m_npart);
+      m_m.resize(m_npart);
+      m_id.resize(m_npart);
+      m_pcode.resize(m_npart);
+      SetPartAddresses();
+    }
+    if(m_evtTree_p->GetEntry(entry) <= 0) return false;
+
+    if(m_isCompactEvtTree){
+      for(Int_t pI = 0; pI < m_npart; ++pI){
+	m_id[pI] = getParticleCodeId(m_pcode[pI]);
+	m_m[pI] = getParticleCodeMass(m_pcode[pI]);
+      }
+    }
+  }
+
+  return true;
+}
+
+Int_t jetConstituentReader::GetNJet(const Int_t rI) const {return m_njt[rI];}
+Float_t jetConstituentReader::GetJetPt(const Int_t rI, const Int_t jI) const {return m_jtpt[rI][jI];}
+Float_t jetConstituentReader::GetJetEta(const Int_t rI, const Int_t jI) const {return m_jteta[rI][jI];}
+Float_t jetConstituentReader::GetJetPhi(const Int_t rI, const Int_t jI) const {return m_jtphi[rI][jI];}
+
+jetConstituentView jetConstituentReader::GetJetConstituents(const Int_t rI, const Int_t jI) const
+{
+  jetConstituentView view;
+  view.nConst = m_jtnconst[rI][jI];
+  view.partIndices = m_constidx[rI].data() + m_jtconstbegin[rI][jI];
+  if(m_evtTree_p != nullptr){
+    view.partPt = m_pt.data();
+    view.partEta = m_eta.data();
+    view.partPhi = m_phi.data();
+    view.partM = m_m.data();
+    view.partId = m_id.data();
+  }
+  return view;
+}
+
+#endif
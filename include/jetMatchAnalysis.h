@@ -0,0 +1,402 @@
+//Cross-R jet matching of createJetSpectraAndShapes (DOJTMATCH)
+//Every jet of the reference radius JTMATCHREFR passing the nominal spectra selection is matched to the nearest jet of each
+//other R within JTMATCHMAXDR; matched pairs fill pT_R/pT_Rref vs. reference jet pT + the pair DeltaR, per R
+//Candidates come from an etaPhiGrid of each event's R jets, so matching is linear in the jets instead of all pairs
+//JTMATCHREFR -1 takes the smallest R of JTRVALS
+
+#ifndef JETMATCHANALYSIS_H
+#define JETMATCHANALYSIS_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TDirectory.h"
+#include "TEnv.h"
+#include "TFile.h"
+#include "TH1F.h"
+#include "TH2F.h"
+#include "TMath.h"
+
+//local
+#include "include/etaPhiGrid.h"
+#include "include/jetSpectraAnalysis.h"
+#include "include/jetTreeBatchReader.h"
+#include "include/tenvUtil.h"
+
+struct jetMatchConfig
+{
+  //Defaults for params missing from the config
+  Bool_t doJtMatch = false;
+  Float_t refR = -1.0;
+  Float_t maxDR = 0.2;
+  Int_t nRatioBins = 40;
+  Float_t ratioMax = 2.0;
+  Int_t nDRBins = 20;
+  //Positions in JTRVALS of the reference R + of the R it is matched to
+  Int_t refRPos = -1;
+  std::vector<Int_t> targetRPos;
+  //Eta extent of the match grid, the jet acceptance of the input (createPYTHIA JTABSETAMAX)
+  Float_t gridAbsEtaMax = 5.0;
+};
+
+inline std::vector<std::string> getJetMatchParams(){return {"DOJTMATCH", "JTMATCHREFR", "JTMATCHMAXDR", "NJTMATCHRATIOBINS", "JTMATCHRATIOMAX", "NJTMATCHDRBINS"};}
+
+inline void checkJetMatchParams(TEnv* inConfig_p)
+{
+  const jetMatchConfig defaultConfig;
+  checkTEnvParam("DOJTMATCH", defaultConfig.doJtMatch, inConfig_p);
+  checkTEnvParam("JTMATCHREFR", defaultConfig.refR, inConfig_p);
+  checkTEnvParam("JTMATCHMAXDR", defaultConfig.maxDR, inConfig_p);
+  checkTEnvParam("NJTMATCHRATIOBINS", defaultConfig.nRatioBins, inConfig_p);
+  checkTEnvParam("JTMATCHRATIOMAX", defaultConfig.ratioMax, inConfig_p);
+  checkTEnvParam("NJTMATCHDRBINS", defaultConfig.nDRBins, inConfig_p);
+  return;
+}
+
+//Grab + validate the matching params against the input JTRVALS + jet acceptance
+inline bool getJetMatchConfig(TEnv* inConfig_p, const std::vector<float>& rVals, const Float_t gridAbsEtaMax, jetMatchConfig* outConfig)
+{
+  const jetMatchConfig defaultConfig;
+  outConfig->doJtMatch = inConfig_p->GetValue("DOJTMATCH", defaultConfig.doJtMatch);
+  outConfig->refR = inConfig_p->GetValue("JTMATCHREFR", defaultConfig.refR);
+  outConfig->maxDR = inConfig_p->GetValue("JTMATCHMAXDR", defaultConfig.maxDR);
+  outConfig->nRatioBins = inConfig_p->GetValue("NJTMATCHRATIOBINS", defaultConfig.nRatioBins);
+  outConfig->ratioMax = inConfig_p->GetValue("JTMATCHRATIOMAX", defaultConfig.ratioMax);
+  outConfig->nDRBins = inConfig_p->GetValue("NJTMATCHDRBINS", defaultConfig.nDRBins);
+  outConfig->refRPos = -1;
+  outConfig->targetRPos.clear();
+  outConfig->gridAbsEtaMax = gridAbsEtaMax;
+  if(!outConfig->doJtMatch) return true;
+
+  if(rVals.size() < 2){
+    std::cout << __PRETTY_FUNCTION__ << ": DOJTMATCH needs at least 2 JTRVALS, input has " << rVals.size() << ". return false" << std::endl;
+    return false;
+  }
+  if(outConfig->maxDR <= 0.0 || outConfig->ratioMax <= 0.0 || outConfig->nRatioBins < 1 || outConfig->nDRBins < 1){
+    std::cout << __PRETTY_FUNCTION__ << ": given JTMATCHMAXDR '" << outConfig->maxDR << "', JTMATCHRATIOMAX '" << outConfig->ratioMax << "' must be > 0 and NJTMATCHRATIOBINS '" << outConfig->nRatioBins << "', NJTMATCHDRBINS '" << outConfig->nDRBins << "' >= 1. return false" << std::endl;
+    return false;
+  }
+
+  if(outConfig->refR < 0.0) outConfig->refRPos = (Int_t)(std::min_element(rVals.begin(), rVals.end()) - rVals.begin());
+  else{
+    for(unsigned int rI = 0; rI < rVals.size(); ++rI){
+      if(TMath::Abs(rVals[rI] - outConfig->refR) < 0.0001) outConfig->refRPos = rI;
+    }
+  }
+  if(outConfig->refRPos < 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given JTMATCHREFR '" << outConfig->refR << "' is not one of the input JTRVALS. return false" << std::endl;
+    return false;
+  }
+  outConfig->refR = rVals[outConfig->refRPos];
+
+  for(unsigned int rI = 0; rI < rVals.size(); ++rI){
+    if((Int_t)rI != outConfig->refRPos) outConfig->targetRPos.push_back(rI);
+  }
+  return true;
+}
+
+//Same matching + histogram binning
+inline bool isSameJetMatch(const jetMatchConfig& inConfig1, const jetMatchConfig& inConfig2)
+{
+  if(inConfig1.doJtMatch != inConfig2.doJtMatch) return false;
+  if(!inConfig1.doJtMatch) return true;
+  if(inConfig1.refRPos != inConfig2.refRPos) return false;
+  if(inConfig1.maxDR != inConfig2.maxDR) return false;
+  if(inConfig1.nRatioBins != inConfig2.nRatioBins) return false;
+  if(inConfig1.ratioMax != inConfig2.ratioMax) return false;
+  return inConfig1.nDRBins == inConfig2.nDRBins;
+}
+
+//Matched pairs of the reference R + one other R: sumw, sumw2 of pT_R/pT_Rref in [0, ratioMax) + an overflow bin, per
+//reference pt bin, and of DeltaR in [0, maxDR)
+class jetMatchAccumulator
+{
+ public:
+  jetMatchAccumulator(){};
+  ~jetMatchAccumulator(){};
+
+  //ptBinEdges has nPtBins+1 entries, as spectrumAccumulator::Init
+  bool Init(const Int_t nPtBins, const Double_t* ptBinEdges, const Int_t nRatioBins, const Double_t ratioMax, const Int_t nDRBins, const Double_t maxDR);
+  void Reset();
+
+  //refPt must lie within the pt bin edges
+  void Fill(const Float_t refPt, const Double_t ratio, const Double_t deltaR, const Double_t weight);
+  //As TH1::Add(h, scale): contents scaled, errors by scale^2, entries not
+  void Add(const jetMatchAccumulator& inAcc, const Double_t scale = 1.0);
+
+  //Ratio: x the reference pt bins, y the ratio bins (ratios >= ratioMax in the y overflow); DeltaR: x the DeltaR bins
+  bool WriteToHists(TH2* ratioHist_p, TH1* deltaRHist_p) const;
+  bool ReadFromHists(const TH2* ratioHist_p, const TH1* deltaRHist_p);
+
+  Double_t GetEntries() const;
+
+ private:
+  Int_t m_nPtBins = 0;
+  std::vector<Double_t> m_ptBinEdges;
+  Int_t m_nRatioBins = 0;
+  Double_t m_ratioInvWidth = 0.0;
+  Int_t m_nDRBins = 0;
+  Double_t m_drInvWidth = 0.0;
+
+  //[ptBin*(m_nRatioBins + 1) + ratioBin], last ratio bin the overflow
+  std::vector<Double_t> m_ratioSumw, m_ratioSumw2;
+  std::vector<Double_t> m_drSumw, m_drSumw2;
+  Double_t m_entries = 0.0;
+  Bool_t m_isWeighted = false;
+};
+
+bool jetMatchAccumulator::Init(const Int_t nPtBins, const Double_t* ptBinEdges, const Int_t nRatioBins, const Double_t ratioMax, const Int_t nDRBins, const Double_t maxDR)
+{
+  if(nPtBins <= 0 || nRatioBins <= 0 || nDRBins <= 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given nPtBins '" << nPtBins << "', nRatioBins '" << nRatioBins << "', nDRBins '" << nDRBins << "' must be > 0. return false" << std::endl;
+    return false;
+  }
+
+  m_nPtBins = nPtBins;
+  m_ptBinEdges.assign(ptBinEdges, ptBinEdges + nPtBins + 1);
+  m_nRatioBins = nRatioBins;
+  m_ratioInvWidth = nRatioBins/ratioMax;
+  m_nDRBins = nDRBins;
+  m_drInvWidth = nDRBins/maxDR;
+
+  Reset();
+  return true;
+}
+
+void jetMatchAccumulator::Reset()
+{
+  m_ratioSumw.assign(m_nPtBins*(m_nRatioBins + 1), 0.0);
+  m_ratioSumw2.assign(m_nPtBins*(m_nRatioBins + 1), 0.0);
+  m_drSumw.assign(m_nDRBins, 0.0);
+  m_drSumw2.assign(m_nDRBins, 0.0);
+  m_entries = 0.0;
+  m_isWeighted = false;
+  return;
+}
+
+void jetMatchAccumulator::Fill(const Float_t refPt, const Double_t ratio, const Double_t deltaR, const Double_t weight)
+{
+  //Unit weights keep sumw2 == sumw, so only others need the explicit errors
+  if(weight != 1.0) m_isWeighted = true;
+
+  Int_t ptBin = (Int_t)(std::upper_bound(m_ptBinEdges.begin(), m_ptBinEdges.end(), (Double_t)refPt) - m_ptBinEdges.begin()) - 1;
+  ptBin = TMath::Max(0, TMath::Min(m_nPtBins - 1, ptBin));
+  const Int_t ratioBin = ratio*m_ratioInvWidth >= m_nRatioBins ? m_nRatioBins : (Int_t)(ratio*m_ratioInvWidth);
+  const Int_t drBin = TMath::Min(m_nDRBins - 1, (Int_t)(deltaR*m_drInvWidth));
+
+  const Int_t ratioPos = ptBin*(m_nRatioBins + 1) + ratioBin;
+  m_ratioSumw[ratioPos] += weight;
+  m_ratioSumw2[ratioPos] += weight*weight;
+  m_drSumw[drBin] += weight;
+  m_drSumw2[drBin] += weight*weight;
+  m_entries += 1.0;
+  return;
+}
+
+void jetMatchAccumulator::Add(const jetMatchAccumulator& inAcc, const Double_t scale)
+{
+  if(inAcc.m_ratioSumw.size() != m_ratioSumw.size() || inAcc.m_nDRBins != m_nDRBins){
+    std::cout << __PRETTY_FUNCTION__ << ": binning mismatch. return" << std::endl;
+    return;
+  }
+
+  const Double_t scale2 = scale*scale;
+  for(unsigned int bI = 0; bI < m_ratioSumw.size(); ++bI){
+    m_ratioSumw[bI] += scale*inAcc.m_ratioSumw[bI];
+    m_ratioSumw2[bI] += scale2*inAcc.m_ratioSumw2[bI];
+  }
+  for(Int_t bI = 0; bI < m_nDRBins; ++bI){
+    m_drSumw[bI] += scale*inAcc.m_drSumw[bI];
+    m_drSumw2[bI] += scale2*inAcc.m_drSumw2[bI];
+  }
+  m_entries += inAcc.m_entries;
+  m_isWeighted = m_isWeighted || inAcc.m_isWeighted || scale != 1.0;
+  return;
+}
+
+bool jetMatchAccumulator::WriteToHists(TH2* ratioHist_p, TH1* deltaRHist_p) const
+{
+  if(ratioHist_p->GetNbinsX() != m_nPtBins || ratioHist_p->GetNbinsY() != m_nRatioBins || deltaRHist_p->GetNbinsX() != m_nDRBins){
+    std::cout << __PRETTY_FUNCTION__ << ": hists '" << ratioHist_p->GetName() << "', '" << deltaRHist_p->GetName() << "' do not match the accumulator binning. return false" << std::endl;
+    return false;
+  }
+
+  //Unit weights -> sumw2 == sumw, and the default sqrt(content) errors are already correct
+  if(m_isWeighted){
+    if(ratioHist_p->GetSumw2N() == 0) ratioHist_p->Sumw2();
+    if(deltaRHist_p->GetSumw2N() == 0) deltaRHist_p->Sumw2();
+  }
+  for(Int_t pI = 0; pI < m_nPtBins; ++pI){
+    //Ratio bin m_nRatioBins lands in the y overflow, bin m_nRatioBins + 1
+    for(Int_t rI = 0; rI <= m_nRatioBins; ++rI){
+      const Int_t ratioPos = pI*(m_nRatioBins + 1) + rI;
+      ratioHist_p->SetBinContent(pI+1, rI+1, m_ratioSumw[ratioPos]);
+      if(m_isWeighted) ratioHist_p->SetBinError(pI+1, rI+1, TMath::Sqrt(m_ratioSumw2[ratioPos]));
+    }
+  }
+  for(Int_t bI = 0; bI < m_nDRBins; ++bI){
+    deltaRHist_p->SetBinContent(bI+1, m_drSumw[bI]);
+    if(m_isWeighted) deltaRHist_p->SetBinError(bI+1, TMath::Sqrt(m_drSumw2[bI]));
+  }
+  ratioHist_p->SetEntries(m_entries);
+  deltaRHist_p->SetEntries(m_entries);
+
+  return true;
+}
+
+bool jetMatchAccumulator::ReadFromHists(const TH2* ratioHist_p, const TH1* deltaRHist_p)
+{
+  if(ratioHist_p->GetNbinsX() != m_nPtBins || ratioHist_p->GetNbinsY() != m_nRatioBins || deltaRHist_p->GetNbinsX() != m_nDRBins){
+    std::cout << __PRETTY_FUNCTION__ << ": hists '" << ratioHist_p->GetName() << "', '" << deltaRHist_p->GetName() << "' do not match the accumulator binning. return false" << std::endl;
+    return false;
+  }
+
+  //W/o Sumw2 the histograms were filled w/ unit weights, sumw2 == sumw
+  m_isWeighted = ratioHist_p->GetSumw2N() != 0;
+  for(Int_t pI = 0; pI < m_nPtBins; ++pI){
+    for(Int_t rI = 0; rI <= m_nRatioBins; ++rI){
+      const Int_t ratioPos = pI*(m_nRatioBins + 1) + rI;
+      m_ratioSumw[ratioPos] = ratioHist_p->GetBinContent(pI+1, rI+1);
+      if(m_isWeighted) m_ratioSumw2[ratioPos] = ratioHist_p->GetBinError(pI+1, rI+1)*ratioHist_p->GetBinError(pI+1, rI+1);
+      else m_ratioSumw2[ratioPos] = m_ratioSumw[ratioPos];
+    }
+  }
+  for(Int_t bI = 0; bI < m_nDRBins; ++bI){
+    m_drSumw[bI] = deltaRHist_p->GetBinContent(bI+1);
+    if(m_isWeighted) m_drSumw2[bI] = deltaRHist_p->GetBinError(bI+1)*deltaRHist_p->GetBinError(bI+1);
+    else m_drSumw2[bI] = m_drSumw[bI];
+  }
+  m_entries = ratioHist_p->GetEntries();
+
+  return true;
+}
+
+Double_t jetMatchAccumulator::GetEntries() const {return m_entries;}
+
+//One accumulator per matched R, in the order of inConfig.targetRPos, w/ the reference pt binning of the nominal selection
+inline bool initJetMatchAccumulators(const jetMatchConfig& inConfig, const jetSpectraConfig& inSpectraConfig, std::vector<jetMatchAccumulator>* outMatches)
+{
+  outMatches->assign(inConfig.targetRPos.size(), jetMatchAccumulator());
+  for(unsigned int tI = 0; tI < inConfig.targetRPos.size(); ++tI){
+    if(!(*outMatches)[tI].Init(inSpectraConfig.nJtPtBins, inSpectraConfig.jtPtBins.data(), inConfig.nRatioBins, inConfig.ratioMax, inConfig.nDRBins, inConfig.maxDR)) return false;
+  }
+  return true;
+}
+
+inline bool initJetMatchGrid(const jetMatchConfig& inConfig, etaPhiGrid* grid_p){return grid_p->Init(inConfig.maxDR, inConfig.gridAbsEtaMax);}
+
+//Matching of nEvents events; per R index rI, event e owns jets [offsets[rI][e], offsets[rI][e+1]) of pt/eta/phi[rI]
+//Reference jets pass the cuts of inSpectraConfig; grid_p (initJetMatchGrid) + refJets_p are scratch, reused for every event + R
+inline void fillJetMatchColumns(const Long64_t nEvents, const std::vector<const Long64_t*>& offsets, const std::vector<const Float_t*>& pt, const std::vector<const Float_t*>& eta, const std::vector<const Float_t*>& phi, const Float_t* eventWeights, const jetMatchConfig& inConfig, const jetSpectraConfig& inSpectraConfig, etaPhiGrid* grid_p, std::vector<Long64_t>* refJets_p, std::vector<jetMatchAccumulator>* jtMatches_p)
+{
+  const Int_t refRPos = inConfig.refRPos;
+  const Float_t* refPt = pt[refRPos];
+  const Float_t* refEta = eta[refRPos];
+  const Float_t* refPhi = phi[refRPos];
+
+  for(Long64_t eI = 0; eI < nEvents; ++eI){
+    refJets_p->clear();
+    for(Long64_t jI = offsets[refRPos][eI]; jI < offsets[refRPos][eI+1]; ++jI){
+      if(std::fabs(refEta[jI]) > inSpectraConfig.jtAbsEtaMax || refPt[jI] < inSpectraConfig.jtPtMin || refPt[jI] >= inSpectraConfig.jtPtMax) continue;
+      refJets_p->push_back(jI);
+    }
+    if(refJets_p->empty()) continue;
+
+    const Double_t eventWeight = eventWeights == nullptr ? 1.0 : eventWeights[eI];
+    for(unsigned int tI = 0; tI < inConfig.targetRPos.size(); ++tI){
+      const Int_t rI = inConfig.targetRPos[tI];
+      const Long64_t firstJet = offsets[rI][eI];
+      grid_p->Fill((Int_t)(offsets[rI][eI+1] - firstJet), eta[rI] + firstJet, phi[rI] + firstJet);
+
+      for(unsigned int jI = 0; jI < refJets_p->size(); ++jI){
+	const Long64_t refPos = (*refJets_p)[jI];
+	Double_t dR2 = 0.0;
+	const Int_t matchPos = grid_p->FindNearest(refEta[refPos], refPhi[refPos], inConfig.maxDR, &dR2);
+	if(matchPos < 0) continue;
+
+	(*jtMatches_p)[tI].Fill(refPt[refPos], pt[rI][firstJet + matchPos]/refPt[refPos], TMath::Sqrt(dR2), eventWeight);
+      }
+      grid_p->Clear();
+    }
+  }
+  return;
+}
+
+//fillJetMatchColumns over the columns of inBlock
+inline void fillJetMatchBlock(const jetColumnBlock& inBlock, const jetMatchConfig& inConfig, const jetSpectraConfig& inSpectraConfig, etaPhiGrid* grid_p, std::vector<Long64_t>* refJets_p, std::vector<jetMatchAccumulator>* jtMatches_p)
+{
+  if(jtMatches_p->empty()) return;
+
+  const Int_t nR = (Int_t)inBlock.pt.size();
+  std::vector<const Long64_t*> offsets(nR);
+  std::vector<const Float_t*> pt(nR), eta(nR), phi(nR);
+  for(Int_t rI = 0; rI < nR; ++rI){
+    offsets[rI] = inBlock.offsets[rI].data();
+    pt[rI] = inBlock.pt[rI].data();
+    eta[rI] = inBlock.eta[rI].data();
+    phi[rI] = inBlock.phi[rI].data();
+  }
+  fillJetMatchColumns(inBlock.nEvents, offsets, pt, eta, phi, inBlock.weight.empty() ? nullptr : inBlock.weight.data(), inConfig, inSpectraConfig, grid_p, refJets_p, jtMatches_p);
+  return;
+}
+
+//e.g. "jtMatchPtRatio_R0p2_R0p4_h", reference R first
+inline std::string getJetMatchName(const std::string prefix, const Float_t refR, const Float_t rVal)
+{
+  std::string refRStr = Form("R%.1f", refR);
+  refRStr.replace(refRStr.find("."), 1, "p");
+  std::string rStr = Form("R%.1f", rVal);
+  rStr.replace(rStr.find("."), 1, "p");
+  return prefix + "_" + refRStr + "_" + rStr + "_h";
+}
+
+//Matched-pair histograms at the top level of outFile_p, next to the nominal spectra; existing ones are overwritten
+inline bool writeJetMatch(TFile* outFile_p, const jetMatchConfig& inConfig, const jetSpectraConfig& inSpectraConfig, const std::vector<float>& rVals, const bool isWeighted, const std::vector<jetMatchAccumulator>& jtMatches)
+{
+  outFile_p->cd();
+  const std::string yieldStr = isWeighted ? "#sigma (mb)" : "Counts";
+  for(unsigned int tI = 0; tI < jtMatches.size(); ++tI){
+    const Float_t rVal = rVals[inConfig.targetRPos[tI]];
+    const std::string ratioTitle = Form(";Jet p_{T}^{R=%.1f} (GeV);p_{T}^{R=%.1f}/p_{T}^{R=%.1f};%s", inConfig.refR, rVal, inConfig.refR, yieldStr.c_str());
+    const std::string deltaRTitle = Form(";#DeltaR(R=%.1f, R=%.1f);%s", inConfig.refR, rVal, yieldStr.c_str());
+    TH2F* ratioHist_p = new TH2F(getJetMatchName("jtMatchPtRatio", inConfig.refR, rVal).c_str(), ratioTitle.c_str(), inSpectraConfig.nJtPtBins, inSpectraConfig.jtPtBins.data(), inConfig.nRatioBins, 0.0, inConfig.ratioMax);
+    TH1F* deltaRHist_p = new TH1F(getJetMatchName("jtMatchDR", inConfig.refR, rVal).c_str(), deltaRTitle.c_str(), inConfig.nDRBins, 0.0, inConfig.maxDR);
+
+    const bool isWriteGood = jtMatches[tI].WriteToHists(ratioHist_p, deltaRHist_p);
+    if(isWriteGood){
+      ratioHist_p->Write("", TObject::kOverwrite);
+      deltaRHist_p->Write("", TObject::kOverwrite);
+    }
+    delete ratioHist_p;
+    delete deltaRHist_p;
+    if(!isWriteGood) return false;
+  }
+
+  return true;
+}
+
+//Inverse of writeJetMatch; accumulators must be initialized
+inline bool readJetMatch(TFile* inFile_p, const jetMatchConfig& inConfig, const std::vector<float>& rVals, std::vector<jetMatchAccumulator>* jtMatches_p)
+{
+  for(unsigned int tI = 0; tI < jtMatches_p->size(); ++tI){
+    const Float_t rVal = rVals[inConfig.targetRPos[tI]];
+    const std::string ratioName = getJetMatchName("jtMatchPtRatio", inConfig.refR, rVal);
+    const std::string deltaRName = getJetMatchName("jtMatchDR", inConfig.refR, rVal);
+    TH2* ratioHist_p = (TH2*)inFile_p->Get(ratioName.c_str());
+    TH1* deltaRHist_p = (TH1*)inFile_p->Get(deltaRName.c_str());
+    if(ratioHist_p == nullptr || deltaRHist_p == nullptr){
+      std::cout << __PRETTY_FUNCTION__ << ": hists '" << ratioName << "', '" << deltaRName << "' not found in '" << inFile_p->GetName() << "'. return false" << std::endl;
+      return false;
+    }
+    if(!(*jtMatches_p)[tI].ReadFromHists(ratioHist_p, deltaRHist_p)) return false;
+  }
+
+  return true;
+}
+
+#endif
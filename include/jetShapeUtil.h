@@ -0,0 +1,130 @@
+#ifndef JETSHAPEUTIL_H
+#define JETSHAPEUTIL_H
+
+//c+cpp
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+#include "TString.h"
+
+//Jet shape observables from the constituents, all w/ dr = sqrt(deta^2 + dphi^2) to the jet axis:
+// rho(r): differential radial profile, (1/dr)*sum(pt_i, r_a <= dr_i < r_b)/jtpt in nRhoBins equal annuli over [0, R)
+// girth: sum(pt_i*dr_i)/jtpt
+// pTD: sqrt(sum(pt_i^2))/sum(pt_i)
+// angularity lambda^kappa_beta: sum((pt_i/jtpt)^kappa * (dr_i/R)^beta)
+//Jet mass is the E-scheme jet four-vector mass, so is not recomputed here
+struct jetShapes
+{
+  Float_t girth, ptd;
+  std::vector<Float_t> rho;
+  std::vector<Float_t> ang;
+};
+
+class jetShapeCalculator
+{
+ public:
+  jetShapeCalculator(){};
+  jetShapeCalculator(const Float_t inR, const Int_t inNRhoBins, const std::vector<float>& inAngKappas, const std::vector<float>& inAngBetas);
+  ~jetShapeCalculator(){};
+
+  bool Init(const Float_t inR, const Int_t inNRhoBins, const std::vector<float>& inAngKappas, const std::vector<float>& inAngBetas);
+
+  //constIndices index the event particle arrays partPt, partEta, partPhi
+  void Compute(const Float_t jtpt, const Float_t jteta, const Float_t jtphi, const Int_t nConst, const Int_t* constIndices, const Float_t* partPt, const Float_t* partEta, const Float_t* partPhi, jetShapes* outShapes) const;
+
+  Int_t GetNRhoBins() const;
+  Int_t GetNAng() const;
+
+ private:
+  Float_t m_r;
+  Int_t m_nRhoBins;
+  Float_t m_rhoBinWidth;
+  std::vector<float> m_angKappas, m_angBetas;
+};
+
+jetShapeCalculator::jetShapeCalculator(const Float_t inR, const Int_t inNRhoBins, const std::vector<float>& inAngKappas, const std::vector<float>& inAngBetas)
+{
+  Init(inR, inNRhoBins, inAngKappas, inAngBetas);
+  return;
+}
+
+bool jetShapeCalculator::Init(const Float_t inR, const Int_t inNRhoBins, const std::vector<float>& inAngKappas, const std::vector<float>& inAngBetas)
+{
+  if(inR <= 0.0 || inNRhoBins <= 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given R '" << inR << "', nRhoBins '" << inNRhoBins << "' must both be > 0. return false" << std::endl;
+    return false;
+  }
+  if(inAngKappas.size() != inAngBetas.size()){
+    std::cout << __PRETTY_FUNCTION__ << ": given " << inAngKappas.size() << " angularity kappas but " << inAngBetas.size() << " betas. return false" << std::endl;
+    return false;
+  }
+
+  m_r = inR;
+  m_nRhoBins = inNRhoBins;
+  m_rhoBinWidth = m_r/m_nRhoBins;
+  m_angKappas = inAngKappas;
+  m_angBetas = inAngBetas;
+
+  return true;
+}
+
+void jetShapeCalculator::Compute(const Float_t jtpt, const Float_t jteta, const Float_t jtphi, const Int_t nConst, const Int_t* constIndices, const Float_t* partPt, const Float_t* partEta, const Float_t* partPhi, jetShapes* outShapes) const
+{
+  const Int_t nAng = (Int_t)m_angKappas.size();
+
+  outShapes->girth = 0.0;
+  outShapes->ptd = 0.0;
+  outShapes->rho.assign(m_nRhoBins, 0.0);
+  outShapes->ang.assign(nAng, 0.0);
+
+  if(jtpt <= 0.0) return;
+
+  Double_t sumPt = 0.0;
+  Double_t sumPt2 = 0.0;
+  for(Int_t cI = 0; cI < nConst; ++cI){
+    const Int_t pI = constIndices[cI];
+    const Double_t constPt = partPt[pI];
+    const Double_t dEta = partEta[pI] - jteta;
+    Double_t dPhi = TMath::Abs(partPhi[pI] - jtphi);
+    if(dPhi > TMath::Pi()) dPhi = 2.0*TMath::Pi() - dPhi;
+    const Double_t dR = TMath::Sqrt(dEta*dEta + dPhi*dPhi);
+    const Double_t ptFrac = constPt/jtpt;
+
+    sumPt += constPt;
+    sumPt2 += constPt*constPt;
+    outShapes->girth += ptFrac*dR;
+
+    //E-scheme axis can leave constituents at dR >= R; those are outside the profile
+    const Int_t rhoPos = (Int_t)(dR/m_rhoBinWidth);
+    if(rhoPos < m_nRhoBins) outShapes->rho[rhoPos] += ptFrac;
+
+    for(Int_t aI = 0; aI < nAng; ++aI){
+      outShapes->ang[aI] += TMath::Power(ptFrac, m_angKappas[aI])*TMath::Power(dR/m_r, m_angBetas[aI]);
+    }
+  }
+
+  if(sumPt > 0.0) outShapes->ptd = TMath::Sqrt(sumPt2)/sumPt;
+  for(Int_t bI = 0; bI < m_nRhoBins; ++bI){
+    outShapes->rho[bI] /= m_rhoBinWidth;
+  }
+
+  return;
+}
+
+Int_t jetShapeCalculator::GetNRhoBins() const {return m_nRhoBins;}
+Int_t jetShapeCalculator::GetNAng() const {return (Int_t)m_angKappas.size();}
+
+//Branch name tag for angularity (kappa, beta), e.g. K1p0B0p5
+inline std::string getAngularityStr(const Float_t kappa, const Float_t beta)
+{
+  std::string angStr = Form("K%.1fB%.1f", kappa, beta);
+  while(angStr.find(".") != std::string::npos){
+    angStr.replace(angStr.find("."), 1, "p");
+  }
+  return angStr;
+}
+
+#endif
@@ -0,0 +1,283 @@
+//N-dimensional jet histogram of createJetSpectraAndShapes (DOJTSPARSE), e.g. pT x eta x R x girth in one THnSparseD
+//Every jet of every R passing the nominal spectra selection is filled once; only the bins it lands in take memory
+//(include/sparseHistAccumulator.h), so fine binning in several shape observables stays affordable
+//JTSPARSEAXES names the axes: pt (binned as the nominal spectra), eta, phi, r (one bin per JTRVALS value), or a scalar
+//jet shape of a DOJTSHAPES input, read from branches jt<name>R*: m, girth, ptd, angK<kappa>B<beta> (e.g. angK1p0B0p5)
+//NJTSPARSEBINS, JTSPARSEMINS, JTSPARSEMAXS give the binning per axis, in JTSPARSEAXES order; their pt + r entries are unused
+
+#ifndef JETSPARSEANALYSIS_H
+#define JETSPARSEANALYSIS_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TEnv.h"
+#include "TFile.h"
+#include "THnSparse.h"
+#include "TMath.h"
+
+//local
+#include "include/getLinBins.h"
+#include "include/jetSpectraAnalysis.h"
+#include "include/jetTreeBatchReader.h"
+#include "include/sparseHistAccumulator.h"
+#include "include/stringUtil.h"
+#include "include/tenvUtil.h"
+
+//Non-negative axis sources are positions in jetSparseConfig::shapeBranches
+const Int_t sparseAxisPt = -1;
+const Int_t sparseAxisEta = -2;
+const Int_t sparseAxisPhi = -3;
+const Int_t sparseAxisR = -4;
+
+struct jetSparseConfig
+{
+  //Defaults for params missing from the config
+  Bool_t doJtSparse = false;
+  std::string axesStr = "pt,eta,r";
+  std::string nBinsStr = "1,40,1";
+  std::string minsStr = "0.0,-2.0,0.0";
+  std::string maxsStr = "1.0,2.0,1.0";
+  //Per axis: name, source (sparseAxisPt, ... or a shape branch position) + bin edges
+  std::vector<std::string> axisNames;
+  std::vector<Int_t> axisSources;
+  std::vector<std::vector<Double_t> > binEdges;
+  //Per-jet branch prefixes of the shape axes, e.g. "jtgirth", read as extra columns of jetTreeBatchReader
+  std::vector<std::string> shapeBranches;
+  //Axis value of each R index
+  std::vector<Double_t> rVals;
+};
+
+inline std::vector<std::string> getJetSparseParams(){return {"DOJTSPARSE", "JTSPARSEAXES", "NJTSPARSEBINS", "JTSPARSEMINS", "JTSPARSEMAXS"};}
+
+inline void checkJetSparseParams(TEnv* inConfig_p)
+{
+  const jetSparseConfig defaultConfig;
+  checkTEnvParam("DOJTSPARSE", defaultConfig.doJtSparse, inConfig_p);
+  checkTEnvParam("JTSPARSEAXES", defaultConfig.axesStr.c_str(), inConfig_p);
+  checkTEnvParam("NJTSPARSEBINS", defaultConfig.nBinsStr.c_str(), inConfig_p);
+  checkTEnvParam("JTSPARSEMINS", defaultConfig.minsStr.c_str(), inConfig_p);
+  checkTEnvParam("JTSPARSEMAXS", defaultConfig.maxsStr.c_str(), inConfig_p);
+  return;
+}
+
+inline std::string getJetSparseAxisTitle(const std::string axisName)
+{
+  if(axisName == "pt") return "Jet p_{T} (GeV)";
+  if(axisName == "eta") return "Jet #eta";
+  if(axisName == "phi") return "Jet #phi";
+  if(axisName == "r") return "Jet R";
+  if(axisName == "m") return "Jet m (GeV)";
+  if(axisName == "girth") return "Jet girth g";
+  if(axisName == "ptd") return "Jet p_{T}D";
+  return "Jet #lambda " + axisName.substr(3);
+}
+
+//Grab + validate the sparse axes; pt takes the bin edges of the nominal selection inSpectraConfig, r one bin per rVals,
+//edges halfway between neighbouring R
+inline bool getJetSparseConfig(TEnv* inConfig_p, const std::vector<float>& rVals, const jetSpectraConfig& inSpectraConfig, jetSparseConfig* outConfig)
+{
+  const jetSparseConfig defaultConfig;
+  outConfig->doJtSparse = inConfig_p->GetValue("DOJTSPARSE", defaultConfig.doJtSparse);
+  outConfig->axesStr = inConfig_p->GetValue("JTSPARSEAXES", defaultConfig.axesStr.c_str());
+  outConfig->nBinsStr = inConfig_p->GetValue("NJTSPARSEBINS", defaultConfig.nBinsStr.c_str());
+  outConfig->minsStr = inConfig_p->GetValue("JTSPARSEMINS", defaultConfig.minsStr.c_str());
+  outConfig->maxsStr = inConfig_p->GetValue("JTSPARSEMAXS", defaultConfig.maxsStr.c_str());
+  outConfig->axisNames.clear();
+  outConfig->axisSources.clear();
+  outConfig->binEdges.clear();
+  outConfig->shapeBranches.clear();
+  outConfig->rVals.assign(rVals.begin(), rVals.end());
+  if(!outConfig->doJtSparse) return true;
+
+  const std::vector<std::string> axisNames = commaSepStringToVect(outConfig->axesStr);
+  const std::vector<float> nBins = commaSepStringToVectF(outConfig->nBinsStr);
+  const std::vector<float> mins = commaSepStringToVectF(outConfig->minsStr);
+  const std::vector<float> maxs = commaSepStringToVectF(outConfig->maxsStr);
+  if(axisNames.size() == 0 || nBins.size() != axisNames.size() || mins.size() != axisNames.size() || maxs.size() != axisNames.size()){
+    std::cout << __PRETTY_FUNCTION__ << ": given JTSPARSEAXES '" << outConfig->axesStr << "' needs one NJTSPARSEBINS, JTSPARSEMINS, JTSPARSEMAXS entry per axis, given '" << outConfig->nBinsStr << "', '" << outConfig->minsStr << "', '" << outConfig->maxsStr << "'. return false" << std::endl;
+    return false;
+  }
+
+  std::vector<Double_t> sortedRVals(rVals.begin(), rVals.end());
+  std::sort(sortedRVals.begin(), sortedRVals.end());
+
+  for(unsigned int aI = 0; aI < axisNames.size(); ++aI){
+    const std::string axisName = axisNames[aI];
+    if(std::count(axisNames.begin(), axisNames.end(), axisName) != 1){
+      std::cout << __PRETTY_FUNCTION__ << ": axis '" << axisName << "' is given more than once in JTSPARSEAXES '" << outConfig->axesStr << "'. return false" << std::endl;
+      return false;
+    }
+
+    std::vector<Double_t> binEdges;
+    if(axisName == "pt"){
+      outConfig->axisSources.push_back(sparseAxisPt);
+      binEdges = inSpectraConfig.jtPtBins;
+    }
+    else if(axisName == "r"){
+      outConfig->axisSources.push_back(sparseAxisR);
+      const Int_t nRVals = (Int_t)sortedRVals.size();
+      const Double_t lowGap = nRVals == 1 ? 0.1 : sortedRVals[1] - sortedRVals[0];
+      const Double_t highGap = nRVals == 1 ? 0.1 : sortedRVals[nRVals-1] - sortedRVals[nRVals-2];
+      binEdges.push_back(sortedRVals[0] - lowGap/2.0);
+      for(Int_t rI = 1; rI < nRVals; ++rI){
+	binEdges.push_back((sortedRVals[rI-1] + sortedRVals[rI])/2.0);
+      }
+      binEdges.push_back(sortedRVals[nRVals-1] + highGap/2.0);
+    }
+    else{
+      if(axisName == "eta") outConfig->axisSources.push_back(sparseAxisEta);
+      else if(axisName == "phi") outConfig->axisSources.push_back(sparseAxisPhi);
+      else if(axisName == "m" || axisName == "girth" || axisName == "ptd" || axisName.find("angK") == 0){
+	outConfig->axisSources.push_back((Int_t)outConfig->shapeBranches.size());
+	outConfig->shapeBranches.push_back("jt" + axisName);
+      }
+      else{
+	std::cout << __PRETTY_FUNCTION__ << ": axis '" << axisName << "' of JTSPARSEAXES is not one of pt, eta, phi, r, m, girth, ptd, angK<kappa>B<beta>. return false" << std::endl;
+	return false;
+      }
+
+      const Int_t nAxisBins = (Int_t)nBins[aI];
+      if(nAxisBins < 1 || nAxisBins != nBins[aI] || maxs[aI] <= mins[aI]){
+	std::cout << __PRETTY_FUNCTION__ << ": axis '" << axisName << "' needs an integer NJTSPARSEBINS >= 1 + JTSPARSEMAXS > JTSPARSEMINS, given '" << nBins[aI] << "', '" << mins[aI] << "', '" << maxs[aI] << "'. return false" << std::endl;
+	return false;
+      }
+      binEdges.resize(nAxisBins + 1);
+      getLinBins(mins[aI], maxs[aI], nAxisBins, binEdges.data());
+    }
+
+    outConfig->axisNames.push_back(axisName);
+    outConfig->binEdges.push_back(binEdges);
+  }
+
+  return true;
+}
+
+//Same axes + binning
+inline bool isSameJetSparse(const jetSparseConfig& inConfig1, const jetSparseConfig& inConfig2)
+{
+  if(inConfig1.doJtSparse != inConfig2.doJtSparse) return false;
+  if(!inConfig1.doJtSparse) return true;
+  if(inConfig1.axisNames != inConfig2.axisNames) return false;
+  return inConfig1.binEdges == inConfig2.binEdges;
+}
+
+//One accumulator if DOJTSPARSE, else empty
+inline bool initJetSparseAccumulators(const jetSparseConfig& inConfig, std::vector<sparseHistAccumulator>* outSparse)
+{
+  outSparse->clear();
+  if(!inConfig.doJtSparse) return true;
+
+  outSparse->push_back(sparseHistAccumulator());
+  return outSparse->back().Init(inConfig.binEdges);
+}
+
+//Fill of nEvents events; per R index rI, event e owns jets [offsets[rI][e], offsets[rI][e+1]) of pt/eta/phi[rI] +
+//shapes[sI][rI], sI the positions of inConfig.shapeBranches; jets pass the cuts of inSpectraConfig
+inline void fillJetSparseColumns(const Long64_t nEvents, const std::vector<const Long64_t*>& offsets, const std::vector<const Float_t*>& pt, const std::vector<const Float_t*>& eta, const std::vector<const Float_t*>& phi, const std::vector<std::vector<const Float_t*> >& shapes, const Float_t* eventWeights, const jetSparseConfig& inConfig, const jetSpectraConfig& inSpectraConfig, std::vector<sparseHistAccumulator>* jtSparse_p)
+{
+  const Int_t nAxes = (Int_t)inConfig.axisSources.size();
+  std::vector<Double_t> xVals(nAxes);
+
+  for(unsigned int rI = 0; rI < offsets.size(); ++rI){
+    for(Long64_t eI = 0; eI < nEvents; ++eI){
+      const Double_t eventWeight = eventWeights == nullptr ? 1.0 : eventWeights[eI];
+      for(Long64_t jI = offsets[rI][eI]; jI < offsets[rI][eI+1]; ++jI){
+	if(std::fabs(eta[rI][jI]) > inSpectraConfig.jtAbsEtaMax || pt[rI][jI] < inSpectraConfig.jtPtMin || pt[rI][jI] >= inSpectraConfig.jtPtMax) continue;
+
+	for(Int_t aI = 0; aI < nAxes; ++aI){
+	  const Int_t axisSource = inConfig.axisSources[aI];
+	  if(axisSource == sparseAxisPt) xVals[aI] = pt[rI][jI];
+	  else if(axisSource == sparseAxisEta) xVals[aI] = eta[rI][jI];
+	  else if(axisSource == sparseAxisPhi) xVals[aI] = phi[rI][jI];
+	  else if(axisSource == sparseAxisR) xVals[aI] = inConfig.rVals[rI];
+	  else xVals[aI] = shapes[axisSource][rI][jI];
+	}
+	(*jtSparse_p)[0].Fill(xVals.data(), eventWeight);
+      }
+    }
+  }
+  return;
+}
+
+//fillJetSparseColumns over the columns of inBlock, read w/ inConfig.shapeBranches as the extra columns
+inline void fillJetSparseBlock(const jetColumnBlock& inBlock, const jetSparseConfig& inConfig, const jetSpectraConfig& inSpectraConfig, std::vector<sparseHistAccumulator>* jtSparse_p)
+{
+  if(jtSparse_p->empty()) return;
+
+  const Int_t nR = (Int_t)inBlock.pt.size();
+  std::vector<const Long64_t*> offsets(nR);
+  std::vector<const Float_t*> pt(nR), eta(nR), phi(nR);
+  std::vector<std::vector<const Float_t*> > shapes(inBlock.extra.size(), std::vector<const Float_t*>(nR));
+  for(Int_t rI = 0; rI < nR; ++rI){
+    offsets[rI] = inBlock.offsets[rI].data();
+    pt[rI] = inBlock.pt[rI].data();
+    eta[rI] = inBlock.eta[rI].data();
+    phi[rI] = inBlock.phi[rI].data();
+    for(unsigned int sI = 0; sI < inBlock.extra.size(); ++sI){
+      shapes[sI][rI] = inBlock.extra[sI][rI].data();
+    }
+  }
+  fillJetSparseColumns(inBlock.nEvents, offsets, pt, eta, phi, shapes, inBlock.weight.empty() ? nullptr : inBlock.weight.data(), inConfig, inSpectraConfig, jtSparse_p);
+  return;
+}
+
+inline std::string getJetSparseName(){return "jtSparse_h";}
+
+//Empty histogram of the sparse axes, named as the JTSPARSEAXES entries so projections can find them; sumw2 always kept
+inline THnSparseD* newJetSparseHist(const jetSparseConfig& inConfig, const bool isWeighted)
+{
+  const Int_t nAxes = (Int_t)inConfig.axisNames.size();
+  std::vector<Int_t> nBins(nAxes);
+  std::vector<Double_t> mins(nAxes), maxs(nAxes);
+  for(Int_t aI = 0; aI < nAxes; ++aI){
+    nBins[aI] = (Int_t)inConfig.binEdges[aI].size() - 1;
+    mins[aI] = inConfig.binEdges[aI].front();
+    maxs[aI] = inConfig.binEdges[aI].back();
+  }
+
+  const std::string title = std::string(isWeighted ? "#sigma (mb)" : "Counts") + " vs. " + inConfig.axesStr;
+  THnSparseD* sparseHist_p = new THnSparseD(getJetSparseName().c_str(), title.c_str(), nAxes, nBins.data(), mins.data(), maxs.data());
+  for(Int_t aI = 0; aI < nAxes; ++aI){
+    TAxis* axis_p = sparseHist_p->GetAxis(aI);
+    axis_p->Set(nBins[aI], inConfig.binEdges[aI].data());
+    axis_p->SetName(inConfig.axisNames[aI].c_str());
+    axis_p->SetTitle(getJetSparseAxisTitle(inConfig.axisNames[aI]).c_str());
+  }
+  sparseHist_p->Sumw2();
+  return sparseHist_p;
+}
+
+//Sparse histogram at the top level of outFile_p, next to the nominal spectra; an existing one is overwritten
+inline bool writeJetSparse(TFile* outFile_p, const jetSparseConfig& inConfig, const bool isWeighted, const std::vector<sparseHistAccumulator>& jtSparse)
+{
+  if(jtSparse.empty()) return true;
+
+  outFile_p->cd();
+  THnSparseD* sparseHist_p = newJetSparseHist(inConfig, isWeighted);
+  const bool isWriteGood = jtSparse[0].WriteToTHn(sparseHist_p);
+  if(isWriteGood) sparseHist_p->Write("", TObject::kOverwrite);
+  delete sparseHist_p;
+
+  return isWriteGood;
+}
+
+//Inverse of writeJetSparse; accumulators must be initialized
+inline bool readJetSparse(TFile* inFile_p, std::vector<sparseHistAccumulator>* jtSparse_p)
+{
+  if(jtSparse_p->empty()) return true;
+
+  THnBase* sparseHist_p = (THnBase*)inFile_p->Get(getJetSparseName().c_str());
+  if(sparseHist_p == nullptr){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << getJetSparseName() << "' not found in '" << inFile_p->GetName() << "'. return false" << std::endl;
+    return false;
+  }
+  return (*jtSparse_p)[0].ReadFromTHn(sparseHist_p);
+}
+
+#endif
@@ -0,0 +1,361 @@
+//Jet spectra selection + binning config (JTABSETAMAX, NJTPTBINS, JTPTMIN, JTPTMAX, DOJTPTLOGBINS, BATCHSIZE) and the per-block fill
+//Shared by createJetSpectraAndShapes, reading jets from jetTree, and the createPYTHIA pipeline mode, taking jets straight from
+//generation, so both give the same histograms for the same config
+//NVARIANTS adds variant selections filled from the same blocks, e.g. for systematic sweeps: variant v takes KEY.v where given
+//(JTABSETAMAX.v, NJTPTBINS.v, JTPTMIN.v, JTPTMAX.v, DOJTPTLOGBINS.v), the nominal KEY otherwise, and is written to directory VARIANTNAME.v
+//NBOOTSTRAP > 0 adds that many Poisson bootstrap replicas of every spectrum, filled from the same blocks (include/bootstrapAccumulator.h)
+
+#ifndef JETSPECTRAANALYSIS_H
+#define JETSPECTRAANALYSIS_H
+
+//c+cpp
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TDirectory.h"
+#include "TEnv.h"
+#include "TFile.h"
+#include "TH1F.h"
+#include "TH2F.h"
+
+//local
+#include "include/bootstrapAccumulator.h"
+#include "include/getLinBins.h"
+#include "include/getLogBins.h"
+#include "include/jetSpectrumKernel.h"
+#include "include/jetTreeBatchReader.h"
+#include "include/tenvUtil.h"
+
+struct jetSpectraConfig
+{
+  //Defaults for params missing from the config
+  Float_t jtAbsEtaMax = 5.0;
+  Int_t nJtPtBins = 20;
+  Float_t jtPtMin = 15.0;
+  Float_t jtPtMax = 200.0;
+  Bool_t doJtPtLogBins = false;
+  Int_t batchSize = 10000;
+  Int_t nVariants = 0;
+  //Bootstrap replicas per spectrum, 0 for none; the seed is combined w/ each input's RANDOMSEED + evtnum
+  Int_t nBootstrap = 0;
+  ULong64_t bootstrapSeed = 1;
+  //nJtPtBins + 1 edges
+  std::vector<Double_t> jtPtBins;
+  //Output directory, empty for the nominal selection (top level of the file)
+  std::string dirName = "";
+};
+
+inline std::vector<std::string> getJetSpectraParams(){return {"JTABSETAMAX", "NJTPTBINS", "JTPTMIN", "JTPTMAX", "DOJTPTLOGBINS", "BATCHSIZE", "NVARIANTS", "NBOOTSTRAP", "BOOTSTRAPSEED"};}
+//Numbered per-variant params, to pass as skip strings to checkAllTEnvParams; BATCHSIZE + the bootstrap params are shared as all variants see the same blocks
+inline std::vector<std::string> getJetSpectraVariantParams(){return {"JTABSETAMAX.", "NJTPTBINS.", "JTPTMIN.", "JTPTMAX.", "DOJTPTLOGBINS.", "VARIANTNAME."};}
+
+inline void checkJetSpectraParams(TEnv* inConfig_p)
+{
+  const jetSpectraConfig defaultConfig;
+  checkTEnvParam("JTABSETAMAX", defaultConfig.jtAbsEtaMax, inConfig_p);
+  checkTEnvParam("NJTPTBINS", defaultConfig.nJtPtBins, inConfig_p);
+  checkTEnvParam("JTPTMIN", defaultConfig.jtPtMin, inConfig_p);
+  checkTEnvParam("JTPTMAX", defaultConfig.jtPtMax, inConfig_p);
+  checkTEnvParam("DOJTPTLOGBINS", defaultConfig.doJtPtLogBins, inConfig_p);
+  checkTEnvParam("BATCHSIZE", defaultConfig.batchSize, inConfig_p);
+  checkTEnvParam("NVARIANTS", defaultConfig.nVariants, inConfig_p);
+  checkTEnvParam("NBOOTSTRAP", defaultConfig.nBootstrap, inConfig_p);
+  checkTEnvParam("BOOTSTRAPSEED", std::to_string(defaultConfig.bootstrapSeed).c_str(), inConfig_p);
+  return;
+}
+
+//paramName + variantStr if defined (variant override), else paramName
+template <typename T>
+T getJetSpectraValue(TEnv* inConfig_p, const std::string paramName, const std::string variantStr, const T paramDefault)
+{
+  if(variantStr.size() != 0 && inConfig_p->Defined((paramName + variantStr).c_str())) return inConfig_p->GetValue((paramName + variantStr).c_str(), paramDefault);
+  return inConfig_p->GetValue(paramName.c_str(), paramDefault);
+}
+
+//Grab + validate the params of the nominal selection (variantStr empty) or of a variant (variantStr ".v"), then construct the pt binning
+inline bool getJetSpectraConfig(TEnv* inConfig_p, jetSpectraConfig* outConfig, const std::string variantStr = "")
+{
+  const jetSpectraConfig defaultConfig;
+  outConfig->jtAbsEtaMax = getJetSpectraValue(inConfig_p, "JTABSETAMAX", variantStr, defaultConfig.jtAbsEtaMax);
+  outConfig->nJtPtBins = getJetSpectraValue(inConfig_p, "NJTPTBINS", variantStr, defaultConfig.nJtPtBins);
+  outConfig->jtPtMin = getJetSpectraValue(inConfig_p, "JTPTMIN", variantStr, defaultConfig.jtPtMin);
+  outConfig->jtPtMax = getJetSpectraValue(inConfig_p, "JTPTMAX", variantStr, defaultConfig.jtPtMax);
+  outConfig->doJtPtLogBins = getJetSpectraValue(inConfig_p, "DOJTPTLOGBINS", variantStr, defaultConfig.doJtPtLogBins);
+  outConfig->batchSize = inConfig_p->GetValue("BATCHSIZE", defaultConfig.batchSize);
+  outConfig->nVariants = inConfig_p->GetValue("NVARIANTS", defaultConfig.nVariants);
+  outConfig->nBootstrap = inConfig_p->GetValue("NBOOTSTRAP", defaultConfig.nBootstrap);
+  //TEnv has no 64-bit integers, so the seed is kept as a string
+  const std::string bootstrapSeedStr = inConfig_p->GetValue("BOOTSTRAPSEED", std::to_string(defaultConfig.bootstrapSeed).c_str());
+
+  if(outConfig->batchSize < 1){
+    std::cout << __PRETTY_FUNCTION__ << ": given BATCHSIZE '" << outConfig->batchSize << "' must be >= 1. return false" << std::endl;
+    return false;
+  }
+  if(outConfig->nBootstrap < 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given NBOOTSTRAP '" << outConfig->nBootstrap << "' must be >= 0. return false" << std::endl;
+    return false;
+  }
+  if(bootstrapSeedStr.size() == 0 || bootstrapSeedStr.find_first_not_of("0123456789") != std::string::npos){
+    std::cout << __PRETTY_FUNCTION__ << ": given BOOTSTRAPSEED '" << bootstrapSeedStr << "' must be a non-negative integer. return false" << std::endl;
+    return false;
+  }
+  outConfig->bootstrapSeed = std::stoull(bootstrapSeedStr);
+  //getLogBins fills at most 1000 bins + leaves the edges untouched above, so cap both binnings explicitly
+  const Int_t nMaxJtPtBins = 1000;
+  if(outConfig->nJtPtBins < 1 || outConfig->nJtPtBins > nMaxJtPtBins){
+    std::cout << __PRETTY_FUNCTION__ << ": given NJTPTBINS" << variantStr << " '" << outConfig->nJtPtBins << "' must be in [1, " << nMaxJtPtBins << "]. fix, return false" << std::endl;
+    return false;
+  }
+
+  outConfig->jtPtBins.resize(outConfig->nJtPtBins + 1);
+  if(outConfig->doJtPtLogBins) getLogBins(outConfig->jtPtMin, outConfig->jtPtMax, outConfig->nJtPtBins, outConfig->jtPtBins.data());
+  else getLinBins(outConfig->jtPtMin, outConfig->jtPtMax, outConfig->nJtPtBins, outConfig->jtPtBins.data());
+
+  return true;
+}
+
+//Nominal selection first, then the NVARIANTS variants
+inline bool getJetSpectraConfigs(TEnv* inConfig_p, std::vector<jetSpectraConfig>* outConfigs)
+{
+  outConfigs->assign(1, jetSpectraConfig());
+  if(!getJetSpectraConfig(inConfig_p, &(outConfigs->at(0)))) return false;
+
+  const Int_t nVariants = outConfigs->at(0).nVariants;
+  if(nVariants < 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given NVARIANTS '" << nVariants << "' must be >= 0. return false" << std::endl;
+    return false;
+  }
+
+  for(Int_t vI = 0; vI < nVariants; ++vI){
+    const std::string variantStr = "." + std::to_string(vI);
+    jetSpectraConfig variantConfig;
+    if(!getJetSpectraConfig(inConfig_p, &variantConfig, variantStr)) return false;
+    variantConfig.dirName = inConfig_p->GetValue(("VARIANTNAME" + variantStr).c_str(), ("variant" + std::to_string(vI)).c_str());
+
+    for(unsigned int cI = 1; cI < outConfigs->size(); ++cI){
+      if(variantConfig.dirName == outConfigs->at(cI).dirName){
+	std::cout << __PRETTY_FUNCTION__ << ": VARIANTNAME" << variantStr << " '" << variantConfig.dirName << "' is already used by variant " << cI-1 << ". return false" << std::endl;
+	return false;
+      }
+    }
+    outConfigs->push_back(variantConfig);
+  }
+
+  return true;
+}
+
+//One accumulator per selection + R, [cI][rI], w/ the binning of inConfigs[cI]
+inline bool initJetSpectraAccumulators(const std::vector<jetSpectraConfig>& inConfigs, const Int_t nR, std::vector<std::vector<spectrumAccumulator> >* outSpectra)
+{
+  outSpectra->assign(inConfigs.size(), std::vector<spectrumAccumulator>(nR));
+  for(unsigned int cI = 0; cI < inConfigs.size(); ++cI){
+    for(Int_t rI = 0; rI < nR; ++rI){
+      if(!(*outSpectra)[cI][rI].Init(inConfigs[cI].nJtPtBins, inConfigs[cI].jtPtBins.data(), inConfigs[cI].doJtPtLogBins)) return false;
+    }
+  }
+  return true;
+}
+
+//Bootstrap replicas of every spectrum, [cI][rI] as the accumulators; left empty w/o NBOOTSTRAP
+inline bool initJetSpectraBootstraps(const std::vector<jetSpectraConfig>& inConfigs, const Int_t nR, std::vector<std::vector<bootstrapAccumulator> >* outBootstraps)
+{
+  outBootstraps->clear();
+  if(inConfigs[0].nBootstrap == 0) return true;
+
+  outBootstraps->assign(inConfigs.size(), std::vector<bootstrapAccumulator>(nR));
+  for(unsigned int cI = 0; cI < inConfigs.size(); ++cI){
+    for(Int_t rI = 0; rI < nR; ++rI){
+      if(!(*outBootstraps)[cI][rI].Init(inConfigs[cI].nJtPtBins, inConfigs[cI].jtPtBins.data(), inConfigs[cI].nBootstrap)) return false;
+    }
+  }
+  return true;
+}
+
+//Same cuts, binning, bootstrap replicas + output directory
+inline bool isSameJetSpectraSelection(const jetSpectraConfig& inConfig1, const jetSpectraConfig& inConfig2)
+{
+  if(inConfig1.nBootstrap != inConfig2.nBootstrap) return false;
+  if(inConfig1.bootstrapSeed != inConfig2.bootstrapSeed) return false;
+  if(inConfig1.jtAbsEtaMax != inConfig2.jtAbsEtaMax) return false;
+  if(inConfig1.jtPtMin != inConfig2.jtPtMin) return false;
+  if(inConfig1.jtPtMax != inConfig2.jtPtMax) return false;
+  if(inConfig1.doJtPtLogBins != inConfig2.doJtPtLogBins) return false;
+  if(inConfig1.jtPtBins != inConfig2.jtPtBins) return false;
+  return inConfig1.dirName == inConfig2.dirName;
+}
+
+inline std::string getJetSpectrumName(const Float_t rVal)
+{
+  std::string rStr = Form("R%.1f", rVal);
+  rStr.replace(rStr.find("."), 1, "p");
+  return "jtSpectra_" + rStr + "_h";
+}
+
+inline std::string getJetSpectrumBootstrapName(const Float_t rVal)
+{
+  std::string rStr = Form("R%.1f", rVal);
+  rStr.replace(rStr.find("."), 1, "p");
+  return "jtSpectraBoot_" + rStr + "_h";
+}
+
+//Empty spectrum for jet radius rVal; weighted (pthat-binned) input fills cross sections in mb instead of counts
+inline TH1F* newJetSpectrumHist(const Float_t rVal, const jetSpectraConfig& inConfig, const bool isWeighted)
+{
+  std::string name = getJetSpectrumName(rVal);
+  std::string title = ";Jet p_{T} (GeV);Counts";
+  if(isWeighted) title = ";Jet p_{T} (GeV);#sigma (mb)";
+  return new TH1F(name.c_str(), title.c_str(), inConfig.nJtPtBins, inConfig.jtPtBins.data());
+}
+
+//Bootstrap replicas of the spectrum, x the pt bins of newJetSpectrumHist, y bin b+1 replica b
+inline TH2F* newJetSpectrumBootstrapHist(const Float_t rVal, const jetSpectraConfig& inConfig, const bool isWeighted)
+{
+  std::string name = getJetSpectrumBootstrapName(rVal);
+  std::string title = ";Jet p_{T} (GeV);Bootstrap replica;Counts";
+  if(isWeighted) title = ";Jet p_{T} (GeV);Bootstrap replica;#sigma (mb)";
+  return new TH2F(name.c_str(), title.c_str(), inConfig.nJtPtBins, inConfig.jtPtBins.data(), inConfig.nBootstrap, -0.5, inConfig.nBootstrap - 0.5);
+}
+
+//Selection + fill of the R index rI jets of nEvents events for every selection in inConfigs, into (*jtSpectra_p)[cI][rI]
+//Event e owns jets [offsets[e], offsets[e+1]) of pt/eta; eventWeights is nullptr for unweighted input
+//jetWeights_p is scratch for the per-jet weights, expanded once + shared by all selections
+inline void fillJetSpectraColumns(const Int_t rI, const Long64_t nEvents, const Long64_t* offsets, const Float_t* pt, const Float_t* eta, const Float_t* eventWeights, const std::vector<jetSpectraConfig>& inConfigs, std::vector<Float_t>* jetWeights_p, std::vector<std::vector<spectrumAccumulator> >* jtSpectra_p)
+{
+  const Long64_t firstJet = offsets[0];
+  const Long64_t nJets = offsets[nEvents] - firstJet;
+
+  //pthat-binned input: every jet carries its event weight
+  const Float_t* weights_p = nullptr;
+  if(eventWeights != nullptr){
+    jetWeights_p->resize(nJets);
+    for(Long64_t eI = 0; eI < nEvents; ++eI){
+      std::fill(jetWeights_p->begin() + (offsets[eI] - firstJet), jetWeights_p->begin() + (offsets[eI+1] - firstJet), eventWeights[eI]);
+    }
+    weights_p = jetWeights_p->data();
+  }
+
+  //The columns stay in cache across selections
+  for(unsigned int cI = 0; cI < inConfigs.size(); ++cI){
+    (*jtSpectra_p)[cI][rI].FillJets(nJets, pt + firstJet, eta + firstJet, inConfigs[cI].jtAbsEtaMax, inConfigs[cI].jtPtMin, inConfigs[cI].jtPtMax, weights_p);
+  }
+  return;
+}
+
+//fillJetSpectraColumns for every R of inBlock; all jets of the block are contiguous, so selection + binning run over the flat columns
+inline void fillJetSpectraBlock(const jetColumnBlock& inBlock, const std::vector<jetSpectraConfig>& inConfigs, std::vector<Float_t>* jetWeights_p, std::vector<std::vector<spectrumAccumulator> >* jtSpectra_p)
+{
+  const Float_t* eventWeights = inBlock.weight.empty() ? nullptr : inBlock.weight.data();
+  for(unsigned int rI = 0; rI < inBlock.pt.size(); ++rI){
+    fillJetSpectraColumns(rI, inBlock.nEvents, inBlock.offsets[rI].data(), inBlock.pt[rI].data(), inBlock.eta[rI].data(), eventWeights, inConfigs, jetWeights_p, jtSpectra_p);
+  }
+  return;
+}
+
+//Bootstrap counterpart of fillJetSpectraColumns into (*jtBootstraps_p)[cI][rI]; replicaWeights holds the NBOOTSTRAP
+//Poisson counts of each of the nEvents events, drawn once per block + shared by all R + selections
+inline void fillJetSpectraBootstrapColumns(const Int_t rI, const Long64_t nEvents, const Long64_t* offsets, const Float_t* pt, const Float_t* eta, const Float_t* eventWeights, const UChar_t* replicaWeights, const std::vector<jetSpectraConfig>& inConfigs, std::vector<std::vector<bootstrapAccumulator> >* jtBootstraps_p)
+{
+  for(unsigned int cI = 0; cI < inConfigs.size(); ++cI){
+    (*jtBootstraps_p)[cI][rI].FillEvents(nEvents, offsets, pt, eta, inConfigs[cI].jtAbsEtaMax, inConfigs[cI].jtPtMin, inConfigs[cI].jtPtMax, eventWeights, replicaWeights);
+  }
+  return;
+}
+
+//fillJetSpectraBootstrapColumns for every R of inBlock, replica counts keyed on inputKey (getBootstrapInputKey) + the block's evtnum
+//replicaWeights_p is scratch; no-op if jtBootstraps_p is empty (NBOOTSTRAP 0)
+inline void fillJetSpectraBootstrapBlock(const jetColumnBlock& inBlock, const std::vector<jetSpectraConfig>& inConfigs, const ULong64_t inputKey, std::vector<UChar_t>* replicaWeights_p, std::vector<std::vector<bootstrapAccumulator> >* jtBootstraps_p)
+{
+  if(jtBootstraps_p->empty()) return;
+
+  getBootstrapReplicaWeights(inBlock.nEvents, inBlock.evtnum.data(), inputKey, inConfigs[0].nBootstrap, replicaWeights_p);
+  const Float_t* eventWeights = inBlock.weight.empty() ? nullptr : inBlock.weight.data();
+  for(unsigned int rI = 0; rI < inBlock.pt.size(); ++rI){
+    fillJetSpectraBootstrapColumns(rI, inBlock.nEvents, inBlock.offsets[rI].data(), inBlock.pt[rI].data(), inBlock.eta[rI].data(), eventWeights, replicaWeights_p->data(), inConfigs, jtBootstraps_p);
+  }
+  return;
+}
+
+//Nominal spectra at the top level of outFile_p, each variant in its own directory; existing spectra are overwritten
+inline bool writeJetSpectra(TFile* outFile_p, const std::vector<jetSpectraConfig>& inConfigs, const std::vector<float>& rVals, const bool isWeighted, const std::vector<std::vector<spectrumAccumulator> >& jtSpectra)
+{
+  for(unsigned int cI = 0; cI < inConfigs.size(); ++cI){
+    TDirectory* outDir_p = outFile_p;
+    if(inConfigs[cI].dirName.size() != 0) outDir_p = outFile_p->mkdir(inConfigs[cI].dirName.c_str(), "", true);
+    outDir_p->cd();
+
+    for(unsigned int rI = 0; rI < rVals.size(); ++rI){
+      TH1F* jtSpectrum_p = newJetSpectrumHist(rVals[rI], inConfigs[cI], isWeighted);
+      if(!jtSpectra[cI][rI].WriteToTH1(jtSpectrum_p)) return false;
+      jtSpectrum_p->Write("", TObject::kOverwrite);
+      delete jtSpectrum_p;
+    }
+  }
+  outFile_p->cd();
+
+  return true;
+}
+
+//Bootstrap replicas next to their spectra, as writeJetSpectra; nothing to write if jtBootstraps is empty
+inline bool writeJetSpectraBootstraps(TFile* outFile_p, const std::vector<jetSpectraConfig>& inConfigs, const std::vector<float>& rVals, const bool isWeighted, const std::vector<std::vector<bootstrapAccumulator> >& jtBootstraps)
+{
+  for(unsigned int cI = 0; cI < jtBootstraps.size(); ++cI){
+    TDirectory* outDir_p = outFile_p;
+    if(inConfigs[cI].dirName.size() != 0) outDir_p = outFile_p->mkdir(inConfigs[cI].dirName.c_str(), "", true);
+    outDir_p->cd();
+
+    for(unsigned int rI = 0; rI < rVals.size(); ++rI){
+      TH2F* jtBootstrap_p = newJetSpectrumBootstrapHist(rVals[rI], inConfigs[cI], isWeighted);
+      if(!jtBootstraps[cI][rI].WriteToTH2(jtBootstrap_p)) return false;
+      jtBootstrap_p->Write("", TObject::kOverwrite);
+      delete jtBootstrap_p;
+    }
+  }
+  outFile_p->cd();
+
+  return true;
+}
+
+//Inverse of writeJetSpectra, (*jtSpectra_p)[cI][rI] replaced by the spectra in inFile_p; accumulators must be initialized
+inline bool readJetSpectra(TFile* inFile_p, const std::vector<jetSpectraConfig>& inConfigs, const std::vector<float>& rVals, std::vector<std::vector<spectrumAccumulator> >* jtSpectra_p)
+{
+  for(unsigned int cI = 0; cI < inConfigs.size(); ++cI){
+    for(unsigned int rI = 0; rI < rVals.size(); ++rI){
+      std::string histName = getJetSpectrumName(rVals[rI]);
+      if(inConfigs[cI].dirName.size() != 0) histName = inConfigs[cI].dirName + "/" + histName;
+
+      TH1* inHist_p = (TH1*)inFile_p->Get(histName.c_str());
+      if(inHist_p == nullptr){
+	std::cout << __PRETTY_FUNCTION__ << ": hist '" << histName << "' not found in '" << inFile_p->GetName() << "'. return false" << std::endl;
+	return false;
+      }
+      if(!(*jtSpectra_p)[cI][rI].ReadFromTH1(inHist_p)) return false;
+    }
+  }
+
+  return true;
+}
+
+//Inverse of writeJetSpectraBootstraps, as readJetSpectra
+inline bool readJetSpectraBootstraps(TFile* inFile_p, const std::vector<jetSpectraConfig>& inConfigs, const std::vector<float>& rVals, std::vector<std::vector<bootstrapAccumulator> >* jtBootstraps_p)
+{
+  for(unsigned int cI = 0; cI < jtBootstraps_p->size(); ++cI){
+    for(unsigned int rI = 0; rI < rVals.size(); ++rI){
+      std::string histName = getJetSpectrumBootstrapName(rVals[rI]);
+      if(inConfigs[cI].dirName.size() != 0) histName = inConfigs[cI].dirName + "/" + histName;
+
+      TH2* inHist_p = (TH2*)inFile_p->Get(histName.c_str());
+      if(inHist_p == nullptr){
+	std::cout << __PRETTY_FUNCTION__ << ": hist '" << histName << "' not found in '" << inFile_p->GetName() << "'. return false" << std::endl;
+	return false;
+      }
+      if(!(*jtBootstraps_p)[cI][rI].ReadFromTH2(inHist_p)) return false;
+    }
+  }
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,265 @@
+//Selection + binning kernel for jet spectra, replacing per-jet cuts + TH1F::Fill
+//Jets are processed in batches: a branch-free pass (auto-vectorizable) evaluates the |eta| and pt window cuts as a mask
+//and computes the bin index arithmetically, log10 transformed for log bins or by direct division for linear bins,
+//then a scalar pass corrects the guess against the exact bin edges (as TAxis::FindBin) and accumulates sumw + sumw2
+//Results convert to a TH1 w/ the same binning at the end, bin contents + stats identical to the TH1F::Fill path
+
+#ifndef JETSPECTRUMKERNEL_H
+#define JETSPECTRUMKERNEL_H
+
+//c+cpp
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+//ROOT
+#include "TH1.h"
+#include "TMath.h"
+
+//log10 for x > 0 from the float exponent + a quadratic for the mantissa; max error ~2e-3
+//Only used for a first bin guess, which is always corrected against the exact edges
+inline Float_t fastLog10(const Float_t inVal)
+{
+  UInt_t bits;
+  std::memcpy(&bits, &inVal, sizeof(bits));
+  const Float_t exponent = (Float_t)((Int_t)(bits >> 23) - 127);
+  bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+  Float_t mantissa;
+  std::memcpy(&mantissa, &bits, sizeof(mantissa));
+  const Float_t log2Mantissa = (-0.34484843f*mantissa + 2.02466578f)*mantissa - 1.67487759f;
+  return (exponent + log2Mantissa)*0.30102999566f;
+}
+
+class spectrumAccumulator
+{
+ public:
+  spectrumAccumulator(){};
+  ~spectrumAccumulator(){};
+
+  //binEdges has nBins+1 entries, uniform in pt (isLogBins false) or log10(pt) (isLogBins true)
+  bool Init(const Int_t nBins, const Double_t* binEdges, const Bool_t isLogBins);
+  void Reset();
+
+  //Select jets w/ |eta| <= absEtaMax and ptMin <= pt < ptMax from [0, nJets) and fill them, w/ per-jet weights if given
+  void FillJets(const Long64_t nJets, const Float_t* pt, const Float_t* eta, const Float_t absEtaMax, const Float_t ptMin, const Float_t ptMax, const Float_t* weights = nullptr);
+  //As TH1::Add(h, scale): contents + stats scaled, entries not
+  void Add(const spectrumAccumulator& inAcc, const Double_t scale = 1.0);
+
+  //Sets contents, stats + entries of an empty histogram w/ the same binning
+  bool WriteToTH1(TH1* inHist_p) const;
+  //Inverse of WriteToTH1, e.g. to continue filling a histogram from an earlier job; replaces the current contents
+  bool ReadFromTH1(const TH1* inHist_p);
+
+  Double_t GetBinContent(const Int_t binPos) const;
+  Double_t GetEntries() const;
+
+ private:
+  static const Int_t batchSize = 1024;
+
+  Int_t m_nBins = 0;
+  std::vector<Double_t> m_binEdges;
+  Bool_t m_isLogBins = false;
+  Float_t m_transLow = 0.0;
+  Float_t m_transInvWidth = 0.0;
+
+  std::vector<Double_t> m_sumw, m_sumw2;
+  Double_t m_tsumw = 0.0;
+  Double_t m_tsumw2 = 0.0;
+  Double_t m_tsumwx = 0.0;
+  Double_t m_tsumwx2 = 0.0;
+  Double_t m_entries = 0.0;
+  Bool_t m_isWeighted = false;
+
+  Int_t m_batchBins[batchSize];
+
+  void ComputeBatchBins(const Int_t nJets, const Float_t* pt, const Float_t* eta, const Float_t absEtaMax, const Float_t ptMin, const Float_t ptMax);
+  Int_t CorrectBin(Int_t binPos, const Double_t xVal) const;
+};
+
+bool spectrumAccumulator::Init(const Int_t nBins, const Double_t* binEdges, const Bool_t isLogBins)
+{
+  if(nBins <= 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given nBins '" << nBins << "' must be > 0. return false" << std::endl;
+    return false;
+  }
+  if(isLogBins && binEdges[0] <= 0.0){
+    std::cout << __PRETTY_FUNCTION__ << ": log bins need lower edge > 0, given '" << binEdges[0] << "'. return false" << std::endl;
+    return false;
+  }
+
+  m_nBins = nBins;
+  m_binEdges.assign(binEdges, binEdges + nBins + 1);
+  m_isLogBins = isLogBins;
+
+  if(m_isLogBins){
+    m_transLow = TMath::Log10(m_binEdges[0]);
+    m_transInvWidth = nBins/(TMath::Log10(m_binEdges[nBins]) - m_transLow);
+  }
+  else{
+    m_transLow = m_binEdges[0];
+    m_transInvWidth = nBins/(m_binEdges[nBins] - m_binEdges[0]);
+  }
+
+  Reset();
+  return true;
+}
+
+void spectrumAccumulator::Reset()
+{
+  m_sumw.assign(m_nBins, 0.0);
+  m_sumw2.assign(m_nBins, 0.0);
+  m_tsumw = 0.0;
+  m_tsumw2 = 0.0;
+  m_tsumwx = 0.0;
+  m_tsumwx2 = 0.0;
+  m_entries = 0.0;
+  m_isWeighted = false;
+  return;
+}
+
+//Branch-free over the batch so the compiler can vectorize it; -1 marks rejected jets
+void spectrumAccumulator::ComputeBatchBins(const Int_t nJets, const Float_t* pt, const Float_t* eta, const Float_t absEtaMax, const Float_t ptMin, const Float_t ptMax)
+{
+  const Float_t transLow = m_transLow;
+  const Float_t transInvWidth = m_transInvWidth;
+  const Int_t maxBin = m_nBins - 1;
+  Int_t* batchBins = m_batchBins;
+
+  if(m_isLogBins){
+    for(Int_t jI = 0; jI < nJets; ++jI){
+      const Float_t ptVal = pt[jI];
+      const Int_t isSelected = (std::fabs(eta[jI]) <= absEtaMax) & (ptVal >= ptMin) & (ptVal < ptMax);
+      //Clamped so the transform never sees pt outside the binned range
+      const Float_t ptClamped = ptVal < ptMin ? ptMin : (ptVal > ptMax ? ptMax : ptVal);
+      Int_t binPos = (Int_t)((fastLog10(ptClamped) - transLow)*transInvWidth);
+      binPos = binPos < 0 ? 0 : (binPos > maxBin ? maxBin : binPos);
+      batchBins[jI] = isSelected ? binPos : -1;
+    }
+  }
+  else{
+    for(Int_t jI = 0; jI < nJets; ++jI){
+      const Float_t ptVal = pt[jI];
+      const Int_t isSelected = (std::fabs(eta[jI]) <= absEtaMax) & (ptVal >= ptMin) & (ptVal < ptMax);
+      const Float_t ptClamped = ptVal < ptMin ? ptMin : (ptVal > ptMax ? ptMax : ptVal);
+      Int_t binPos = (Int_t)((ptClamped - transLow)*transInvWidth);
+      binPos = binPos < 0 ? 0 : (binPos > maxBin ? maxBin : binPos);
+      batchBins[jI] = isSelected ? binPos : -1;
+    }
+  }
+  return;
+}
+
+//Exact bin: binEdges[binPos] <= xVal < binEdges[binPos+1], as TAxis::FindBin on the same edges
+Int_t spectrumAccumulator::CorrectBin(Int_t binPos, const Double_t xVal) const
+{
+  while(binPos > 0 && xVal < m_binEdges[binPos]) --binPos;
+  while(binPos < m_nBins - 1 && xVal >= m_binEdges[binPos+1]) ++binPos;
+  return binPos;
+}
+
+void spectrumAccumulator::FillJets(const Long64_t nJets, const Float_t* pt, const Float_t* eta, const Float_t absEtaMax, const Float_t ptMin, const Float_t ptMax, const Float_t* weights)
+{
+  if(weights != nullptr) m_isWeighted = true;
+
+  for(Long64_t batchStart = 0; batchStart < nJets; batchStart += batchSize){
+    const Int_t nBatch = (Int_t)TMath::Min((Long64_t)batchSize, nJets - batchStart);
+    const Float_t* batchPt = pt + batchStart;
+    ComputeBatchBins(nBatch, batchPt, eta + batchStart, absEtaMax, ptMin, ptMax);
+
+    for(Int_t jI = 0; jI < nBatch; ++jI){
+      if(m_batchBins[jI] < 0) continue;
+
+      //Same accumulation as TH1::Fill(x, w)
+      const Double_t xVal = batchPt[jI];
+      const Double_t wVal = weights == nullptr ? 1.0 : weights[batchStart + jI];
+      const Int_t binPos = CorrectBin(m_batchBins[jI], xVal);
+      m_sumw[binPos] += wVal;
+      m_sumw2[binPos] += wVal*wVal;
+      m_tsumw += wVal;
+      m_tsumw2 += wVal*wVal;
+      m_tsumwx += wVal*xVal;
+      m_tsumwx2 += wVal*xVal*xVal;
+      m_entries += 1.0;
+    }
+  }
+  return;
+}
+
+void spectrumAccumulator::Add(const spectrumAccumulator& inAcc, const Double_t scale)
+{
+  if(inAcc.m_nBins != m_nBins){
+    std::cout << __PRETTY_FUNCTION__ << ": nBins mismatch, " << inAcc.m_nBins << " vs. " << m_nBins << ". return" << std::endl;
+    return;
+  }
+
+  const Double_t scale2 = scale*scale;
+  for(Int_t bI = 0; bI < m_nBins; ++bI){
+    m_sumw[bI] += scale*inAcc.m_sumw[bI];
+    m_sumw2[bI] += scale2*inAcc.m_sumw2[bI];
+  }
+  m_tsumw += scale*inAcc.m_tsumw;
+  m_tsumw2 += scale2*inAcc.m_tsumw2;
+  m_tsumwx += scale*inAcc.m_tsumwx;
+  m_tsumwx2 += scale*inAcc.m_tsumwx2;
+  m_entries += inAcc.m_entries;
+  m_isWeighted = m_isWeighted || inAcc.m_isWeighted || scale != 1.0;
+  return;
+}
+
+bool spectrumAccumulator::WriteToTH1(TH1* inHist_p) const
+{
+  if(inHist_p->GetNbinsX() != m_nBins){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << inHist_p->GetName() << "' has " << inHist_p->GetNbinsX() << " bins, expected " << m_nBins << ". return false" << std::endl;
+    return false;
+  }
+
+  //SetBinContent touches entries + stats, so those are set last
+  for(Int_t bI = 0; bI < m_nBins; ++bI){
+    inHist_p->SetBinContent(bI+1, m_sumw[bI]);
+  }
+  //Unit weights -> sumw2 == sumw, and the default sqrt(content) errors are already correct
+  if(m_isWeighted){
+    if(inHist_p->GetSumw2N() == 0) inHist_p->Sumw2();
+    for(Int_t bI = 0; bI < m_nBins; ++bI){
+      inHist_p->SetBinError(bI+1, TMath::Sqrt(m_sumw2[bI]));
+    }
+  }
+
+  Double_t stats[4] = {m_tsumw, m_tsumw2, m_tsumwx, m_tsumwx2};
+  inHist_p->PutStats(stats);
+  inHist_p->SetEntries(m_entries);
+
+  return true;
+}
+
+bool spectrumAccumulator::ReadFromTH1(const TH1* inHist_p)
+{
+  if(inHist_p->GetNbinsX() != m_nBins){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << inHist_p->GetName() << "' has " << inHist_p->GetNbinsX() << " bins, expected " << m_nBins << ". return false" << std::endl;
+    return false;
+  }
+
+  //W/o Sumw2 the histogram was filled w/ unit weights, sumw2 == sumw
+  m_isWeighted = inHist_p->GetSumw2N() != 0;
+  for(Int_t bI = 0; bI < m_nBins; ++bI){
+    m_sumw[bI] = inHist_p->GetBinContent(bI+1);
+    if(m_isWeighted) m_sumw2[bI] = inHist_p->GetBinError(bI+1)*inHist_p->GetBinError(bI+1);
+    else m_sumw2[bI] = m_sumw[bI];
+  }
+
+  Double_t stats[4];
+  inHist_p->GetStats(stats);
+  m_tsumw = stats[0];
+  m_tsumw2 = stats[1];
+  m_tsumwx = stats[2];
+  m_tsumwx2 = stats[3];
+  m_entries = inHist_p->GetEntries();
+
+  return true;
+}
+
+Double_t spectrumAccumulator::GetBinContent(const Int_t binPos) const {return m_sumw[binPos];}
+Double_t spectrumAccumulator::GetEntries() const {return m_entries;}
+
+#endif
@@ -0,0 +1,232 @@
+//Block reader for the createPYTHIA jetTree
+//Reads njtR*/jtpt*/jteta*/jtphi* for thousands of events at a time into flat per-R structure-of-arrays buffers
+//Branches are read one at a time (only enabled ones, no TTree::GetEntry fan-out), so each basket is decompressed once
+//and consecutive jets of a block land in contiguous memory for the selection + fill loop
+//Optional extra per-jet Float_t columns (e.g. jet shapes, prefix "jtgirth" for jtgirthR*) are read the same way
+
+#ifndef JETTREEBATCHREADER_H
+#define JETTREEBATCHREADER_H
+
+//c+cpp
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TMath.h"
+#include "TTree.h"
+
+struct jetColumnBlock
+{
+  Long64_t firstEntry = 0;
+  Long64_t nEvents = 0;
+  //Per R index rI: jets of event e in the block are [offsets[rI][e], offsets[rI][e+1]) of pt/eta/phi[rI]
+  std::vector<std::vector<Long64_t> > offsets;
+  std::vector<std::vector<Float_t> > pt, eta, phi;
+  //Per-event weight of the block's events, empty if the tree has no weight branch (unweighted generation)
+  std::vector<Float_t> weight;
+  //Global event number (createPYTHIA evtnum) of the block's events; trees written before evtnum existed get the entry number
+  std::vector<ULong64_t> evtnum;
+  //Extra column cI of R index rI, jets as pt[rI]; empty w/o extra columns
+  std::vector<std::vector<std::vector<Float_t> > > extra;
+};
+
+class jetTreeBatchReader
+{
+ public:
+  jetTreeBatchReader(){};
+  ~jetTreeBatchReader(){};
+
+  //extraPrefixes: branch prefixes of the extra columns, read as prefix + R string (e.g. jtgirthR0p4)
+  bool Init(TTree* inTree_p, std::vector<float> rParams, const Long64_t firstEntry, const Long64_t lastEntry, const std::vector<std::string>& extraPrefixes = {});
+  //Reads entries [firstEntry, firstEntry + nEvents), clipped to the tree
+  bool ReadBlock(const Long64_t firstEntry, const Long64_t nEvents, jetColumnBlock* outBlock);
+  bool HasWeight() const;
+  bool HasEventNumber() const;
+
+ private:
+  TTree* m_tree_p = nullptr;
+  Int_t m_nR = 0;
+  std::vector<TBranch*> m_njtBranches, m_ptBranches, m_etaBranches, m_phiBranches;
+  //[cI][rI]
+  std::vector<std::vector<TBranch*> > m_extraBranches;
+  std::vector<Int_t> m_njt;
+  TBranch* m_weightBranch_p = nullptr;
+  Float_t m_weight = 1.0;
+  TBranch* m_evtNumBranch_p = nullptr;
+  ULong64_t m_evtNum = 0;
+  //One scratch array shared by all array branches, each is copied out right after it is read
+  std::vector<Float_t> m_scratch;
+
+  void SetScratchAddresses();
+};
+
+bool jetTreeBatchReader::Init(TTree* inTree_p, std::vector<float> rParams, const Long64_t firstEntry, const Long64_t lastEntry, const std::vector<std::string>& extraPrefixes)
+{
+  m_tree_p = inTree_p;
+  m_nR = (Int_t)rParams.size();
+  m_njtBranches.assign(m_nR, nullptr);
+  m_ptBranches.assign(m_nR, nullptr);
+  m_etaBranches.assign(m_nR, nullptr);
+  m_phiBranches.assign(m_nR, nullptr);
+  m_njt.assign(m_nR, 0);
+  m_extraBranches.assign(extraPrefixes.size(), std::vector<TBranch*>(m_nR, nullptr));
+
+  //Cache only the branches we read, over only the entry range we read
+  const Long64_t cacheSize = 30000000;
+  m_tree_p->SetBranchStatus("*", 0);
+  m_tree_p->SetCacheSize(cacheSize);
+  m_tree_p->SetCacheEntryRange(firstEntry, lastEntry);
+
+  Int_t maxNJt = 1;
+  for(Int_t rI = 0; rI < m_nR; ++rI){
+    std::string rStr = Form("R%.1f", rParams[rI]);
+    rStr.replace(rStr.find("."), 1, "p");
+
+    const std::string nRStr = "njt" + rStr;
+    std::vector<std::string> branchNames = {nRStr, "jtpt" + rStr, "jteta" + rStr, "jtphi" + rStr};
+    for(unsigned int cI = 0; cI < extraPrefixes.size(); ++cI){
+      branchNames.push_back(extraPrefixes[cI] + rStr);
+    }
+    std::vector<TBranch*> branches;
+    for(unsigned int bI = 0; bI < branchNames.size(); ++bI){
+      branches.push_back(m_tree_p->GetBranch(branchNames[bI].c_str()));
+      if(branches.back() == nullptr){
+	std::cout << __PRETTY_FUNCTION__ << ": branch '" << branchNames[bI] << "' not found in tree '" << m_tree_p->GetName() << "'. return false" << std::endl;
+	return false;
+      }
+      m_tree_p->SetBranchStatus(branchNames[bI].c_str(), 1);
+      m_tree_p->AddBranchToCache(branches.back());
+    }
+
+    m_njtBranches[rI] = branches[0];
+    m_ptBranches[rI] = branches[1];
+    m_etaBranches[rI] = branches[2];
+    m_phiBranches[rI] = branches[3];
+    for(unsigned int cI = 0; cI < extraPrefixes.size(); ++cI){
+      m_extraBranches[cI][rI] = branches[4 + cI];
+    }
+    m_njtBranches[rI]->SetAddress(&(m_njt[rI]));
+
+    //Count leaves record the largest value written
+    TLeaf* njtLeaf_p = m_tree_p->GetLeaf(nRStr.c_str());
+    if(njtLeaf_p != nullptr) maxNJt = TMath::Max(maxNJt, njtLeaf_p->GetMaximum());
+  }
+  //pthat-binned generation adds a per-event cross-section weight
+  m_weightBranch_p = m_tree_p->GetBranch("weight");
+  if(m_weightBranch_p != nullptr){
+    m_tree_p->SetBranchStatus("weight", 1);
+    m_tree_p->AddBranchToCache(m_weightBranch_p);
+    m_weightBranch_p->SetAddress(&m_weight);
+  }
+  m_evtNumBranch_p = m_tree_p->GetBranch("evtnum");
+  if(m_evtNumBranch_p != nullptr){
+    m_tree_p->SetBranchStatus("evtnum", 1);
+    m_tree_p->AddBranchToCache(m_evtNumBranch_p);
+    m_evtNumBranch_p->SetAddress(&m_evtNum);
+  }
+  m_tree_p->StopCacheLearningPhase();
+
+  m_scratch.resize(maxNJt);
+  SetScratchAddresses();
+
+  return true;
+}
+
+void jetTreeBatchReader::SetScratchAddresses()
+{
+  for(Int_t rI = 0; rI < m_nR; ++rI){
+    m_ptBranches[rI]->SetAddress(m_scratch.data());
+    m_etaBranches[rI]->SetAddress(m_scratch.data());
+    m_phiBranches[rI]->SetAddress(m_scratch.data());
+    for(unsigned int cI = 0; cI < m_extraBranches.size(); ++cI){
+      m_extraBranches[cI][rI]->SetAddress(m_scratch.data());
+    }
+  }
+  return;
+}
+
+bool jetTreeBatchReader::ReadBlock(const Long64_t firstEntry, const Long64_t nEvents, jetColumnBlock* outBlock)
+{
+  if(m_tree_p == nullptr){
+    std::cout << __PRETTY_FUNCTION__ << ": reader not initialized. return false" << std::endl;
+    return false;
+  }
+
+  const Long64_t lastEntry = TMath::Min(firstEntry + nEvents, m_tree_p->GetEntries());
+  outBlock->firstEntry = firstEntry;
+  outBlock->nEvents = TMath::Max((Long64_t)0, lastEntry - firstEntry);
+  outBlock->offsets.resize(m_nR);
+  outBlock->pt.resize(m_nR);
+  outBlock->eta.resize(m_nR);
+  outBlock->phi.resize(m_nR);
+  outBlock->extra.resize(m_extraBranches.size());
+  outBlock->weight.clear();
+  //TBranch::GetEntry returns < 0 on an I/O error; the whole block is then bad
+  Int_t minReadBytes = 0;
+  if(m_weightBranch_p != nullptr){
+    for(Long64_t entry = firstEntry; entry < lastEntry; ++entry){
+      minReadBytes = TMath::Min(minReadBytes, m_weightBranch_p->GetEntry(entry));
+      outBlock->weight.push_back(m_weight);
+    }
+  }
+  outBlock->evtnum.clear();
+  for(Long64_t entry = firstEntry; entry < lastEntry; ++entry){
+    if(m_evtNumBranch_p != nullptr) minReadBytes = TMath::Min(minReadBytes, m_evtNumBranch_p->GetEntry(entry));
+    else m_evtNum = entry;
+    outBlock->evtnum.push_back(m_evtNum);
+  }
+
+  //R-major: every branch walks forward through its own baskets exactly once per block
+  for(Int_t rI = 0; rI < m_nR; ++rI){
+    std::vector<Long64_t>* offsets_p = &(outBlock->offsets[rI]);
+    std::vector<Float_t>* pt_p = &(outBlock->pt[rI]);
+    std::vector<Float_t>* eta_p = &(outBlock->eta[rI]);
+    std::vector<Float_t>* phi_p = &(outBlock->phi[rI]);
+    offsets_p->assign(1, 0);
+    pt_p->clear();
+    eta_p->clear();
+    phi_p->clear();
+    for(unsigned int cI = 0; cI < m_extraBranches.size(); ++cI){
+      outBlock->extra[cI].resize(m_nR);
+      outBlock->extra[cI][rI].clear();
+    }
+
+    for(Long64_t entry = firstEntry; entry < lastEntry; ++entry){
+      minReadBytes = TMath::Min(minReadBytes, m_njtBranches[rI]->GetEntry(entry));
+      const Int_t nJt = m_njt[rI];
+      if(nJt > (Int_t)m_scratch.size()){
+	m_scratch.resize(nJt);
+	SetScratchAddresses();
+      }
+
+      minReadBytes = TMath::Min(minReadBytes, m_ptBranches[rI]->GetEntry(entry));
+      pt_p->insert(pt_p->end(), m_scratch.begin(), m_scratch.begin() + nJt);
+      minReadBytes = TMath::Min(minReadBytes, m_etaBranches[rI]->GetEntry(entry));
+      eta_p->insert(eta_p->end(), m_scratch.begin(), m_scratch.begin() + nJt);
+      minReadBytes = TMath::Min(minReadBytes, m_phiBranches[rI]->GetEntry(entry));
+      phi_p->insert(phi_p->end(), m_scratch.begin(), m_scratch.begin() + nJt);
+      for(unsigned int cI = 0; cI < m_extraBranches.size(); ++cI){
+	minReadBytes = TMath::Min(minReadBytes, m_extraBranches[cI][rI]->GetEntry(entry));
+	outBlock->extra[cI][rI].insert(outBlock->extra[cI][rI].end(), m_scratch.begin(), m_scratch.begin() + nJt);
+      }
+
+      offsets_p->push_back(offsets_p->back() + nJt);
+    }
+  }
+
+  if(minReadBytes < 0){
+    std::cout << __PRETTY_FUNCTION__ << ": I/O error reading entries [" << firstEntry << ", " << lastEntry << ") of '" << m_tree_p->GetName() << "'. return false" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool jetTreeBatchReader::HasWeight() const {return m_weightBranch_p != nullptr;}
+bool jetTreeBatchReader::HasEventNumber() const {return m_evtNumBranch_p != nullptr;}
+
+#endif
@@ -0,0 +1,166 @@
+//Merging of job outputs, shared by mergeJetShapes + the createPYTHIA shard merge: consistency of the job configs stored
+//in the inputs, the provenance records written to the merged config + an ordered parallel reduction
+
+#ifndef MERGEUTIL_H
+#define MERGEUTIL_H
+
+//c+cpp
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//ROOT
+#include "TEnv.h"
+#include "THashList.h"
+
+//local
+#include "include/stringUtil.h"
+
+//Which entries of which input files the output spectra contain, recorded in the createJetSpectraAndShapes job config
+//An input is identified by its TFile UUID, new for every (re)created file, so a replaced input is not mistaken for a grown one
+struct inputProgress
+{
+  std::string fileName = "";
+  std::string uuid = "";
+  Long64_t nEntries = 0;
+};
+
+inline std::vector<inputProgress> getInputProgress(TEnv* inConfig_p)
+{
+  std::vector<inputProgress> progress;
+  const Int_t nInputs = inConfig_p->GetValue("NINPUTSDONE", 0);
+  for(Int_t iI = 0; iI < nInputs; ++iI){
+    inputProgress input;
+    input.fileName = inConfig_p->GetValue(("INPUTDONENAME." + std::to_string(iI)).c_str(), "");
+    input.uuid = inConfig_p->GetValue(("INPUTDONEUUID." + std::to_string(iI)).c_str(), "");
+    input.nEntries = std::stoll(inConfig_p->GetValue(("INPUTDONEENTRIES." + std::to_string(iI)).c_str(), "0"));
+    progress.push_back(input);
+  }
+  return progress;
+}
+
+inline void setInputProgress(TEnv* inConfig_p, const std::vector<inputProgress>& progress)
+{
+  inConfig_p->SetValue("NINPUTSDONE", (Int_t)progress.size());
+  for(unsigned int iI = 0; iI < progress.size(); ++iI){
+    inConfig_p->SetValue(("INPUTDONENAME." + std::to_string(iI)).c_str(), progress[iI].fileName.c_str());
+    inConfig_p->SetValue(("INPUTDONEUUID." + std::to_string(iI)).c_str(), progress[iI].uuid.c_str());
+    inConfig_p->SetValue(("INPUTDONEENTRIES." + std::to_string(iI)).c_str(), std::to_string(progress[iI].nEntries).c_str());
+  }
+  return;
+}
+
+//One input of a merge, as recorded in the merged configs: NMERGEINPUTS + MERGEINPUTNAME.i, MERGEINPUTUUID.i,
+//MERGEINPUTENTRIES.i (jetTree entries, or for spectra the entries they were filled from), MERGEINPUTSEED.i (RANDOMSEED)
+struct mergeInput
+{
+  std::string fileName = "";
+  std::string uuid = "";
+  Long64_t nEntries = 0;
+  std::string randomSeed = "";
+};
+
+inline void setMergeProvenance(TEnv* outConfig_p, const std::vector<mergeInput>& inputs)
+{
+  outConfig_p->SetValue("NMERGEINPUTS", (Int_t)inputs.size());
+  for(unsigned int iI = 0; iI < inputs.size(); ++iI){
+    const std::string iStr = "." + std::to_string(iI);
+    outConfig_p->SetValue(("MERGEINPUTNAME" + iStr).c_str(), inputs[iI].fileName.c_str());
+    outConfig_p->SetValue(("MERGEINPUTUUID" + iStr).c_str(), inputs[iI].uuid.c_str());
+    outConfig_p->SetValue(("MERGEINPUTENTRIES" + iStr).c_str(), std::to_string(inputs[iI].nEntries).c_str());
+    outConfig_p->SetValue(("MERGEINPUTSEED" + iStr).c_str(), inputs[iI].randomSeed.c_str());
+  }
+  return;
+}
+
+//Inverse of setMergeProvenance; empty for a config that was never merged, so a merge of merged files can list the original inputs
+inline std::vector<mergeInput> getMergeProvenance(TEnv* inConfig_p)
+{
+  std::vector<mergeInput> inputs;
+  const Int_t nInputs = inConfig_p->GetValue("NMERGEINPUTS", 0);
+  for(Int_t iI = 0; iI < nInputs; ++iI){
+    const std::string iStr = "." + std::to_string(iI);
+    mergeInput input;
+    input.fileName = inConfig_p->GetValue(("MERGEINPUTNAME" + iStr).c_str(), "");
+    input.uuid = inConfig_p->GetValue(("MERGEINPUTUUID" + iStr).c_str(), "");
+    input.nEntries = std::stoll(inConfig_p->GetValue(("MERGEINPUTENTRIES" + iStr).c_str(), "0"));
+    input.randomSeed = inConfig_p->GetValue(("MERGEINPUTSEED" + iStr).c_str(), "");
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+//Names of all params of inConfig_p, except those containing one of skipStrings (as the skipStrings of checkAllTEnvParams)
+inline std::vector<std::string> getTEnvParamNames(TEnv* inConfig_p, std::vector<std::string> skipStrings = {})
+{
+  std::vector<std::string> paramNames;
+  THashList* inConfigList_p = inConfig_p->GetTable();
+  for(Int_t entry = 0; entry < inConfigList_p->GetEntries(); ++entry){
+    const std::string entryName = inConfigList_p->At(entry)->GetName();
+
+    bool isSkipString = false;
+    for(unsigned int sI = 0; sI < skipStrings.size(); ++sI){
+      if(entryName.find(skipStrings[sI]) != std::string::npos){
+	isSkipString = true;
+	break;
+      }
+    }
+    if(!isSkipString) paramNames.push_back(entryName);
+  }
+  return paramNames;
+}
+
+//Every param in paramList must have the same value in inConfig_p as in refConfig_p, a param missing from one of them
+//included; all differences are printed before returning false
+inline bool checkTEnvParamsSame(TEnv* refConfig_p, TEnv* inConfig_p, const std::vector<std::string>& paramList, const std::string inLabel)
+{
+  bool allParamsSame = true;
+  for(unsigned int pI = 0; pI < paramList.size(); ++pI){
+    const bool isRefDefined = refConfig_p->Defined(paramList[pI].c_str());
+    const bool isInDefined = inConfig_p->Defined(paramList[pI].c_str());
+    const std::string refVal = refConfig_p->GetValue(paramList[pI].c_str(), "");
+    const std::string inVal = inConfig_p->GetValue(paramList[pI].c_str(), "");
+    if(isRefDefined == isInDefined && isStrSame(refVal, inVal)) continue;
+
+    std::cout << __PRETTY_FUNCTION__ << ": " << inLabel << " param '" << paramList[pI] << "' is '" << (isInDefined ? inVal : "<missing>") << "', expected '" << (isRefDefined ? refVal : "<missing>") << "'." << std::endl;
+    allParamsSame = false;
+  }
+  return allParamsSame;
+}
+
+//As checkTEnvParamsSame over all params of either config, except those containing one of skipStrings
+inline bool checkAllTEnvParamsSame(TEnv* refConfig_p, TEnv* inConfig_p, const std::string inLabel, std::vector<std::string> skipStrings = {})
+{
+  std::vector<std::string> paramList = getTEnvParamNames(refConfig_p, skipStrings);
+  std::vector<std::string> inParamList = getTEnvParamNames(inConfig_p, skipStrings);
+  for(unsigned int pI = 0; pI < inParamList.size(); ++pI){
+    if(!refConfig_p->Defined(inParamList[pI].c_str())) paramList.push_back(inParamList[pI]);
+  }
+  return checkTEnvParamsSame(refConfig_p, inConfig_p, paramList, inLabel);
+}
+
+//Contiguous input range [first, last) of part partPos of nParts, as the per-thread entry ranges of createJetSpectraAndShapes
+inline Int_t getMergePartFirst(const Int_t nInputs, const Int_t nParts, const Int_t partPos){return (Int_t)(((Long64_t)nInputs*partPos)/nParts);}
+
+//Sum parts (*parts_p)[1..n) into (*parts_p)[0] as a binary tree, each level's pairs on their own threads
+//addFunc(&left, right) adds right into left; pairs are fixed by position, so the result does not depend on scheduling
+template <typename T, typename F>
+void reduceInParallel(std::vector<T>* parts_p, F addFunc)
+{
+  const Int_t nParts = (Int_t)parts_p->size();
+  for(Int_t stride = 1; stride < nParts; stride *= 2){
+    std::vector<std::thread> threads;
+    for(Int_t pI = 0; pI + stride < nParts; pI += 2*stride){
+      threads.push_back(std::thread([parts_p, pI, stride, &addFunc](){
+	    addFunc(&((*parts_p)[pI]), (*parts_p)[pI + stride]);
+	  }));
+    }
+    for(unsigned int tI = 0; tI < threads.size(); ++tI){
+      threads[tI].join();
+    }
+  }
+  return;
+}
+
+#endif
@@ -0,0 +1,457 @@
+//Anti-kt (E-scheme) clustering of one particle list at several jet radii
+//Per-particle preprocessing (rapidity, phi, 1/kt^2) and the rapidity-phi tiling are done once per event and shared by all radii
+//Tiles are sized to the smallest radius; a radius R searches ceil(R/tileWidth) tiles in each direction
+//Algorithm follows the FastJet N2Tiled strategy; jets agree w/ fastjet::antikt_algorithm + E_scheme up to floating point ties
+
+#ifndef MULTIRCLUSTERER_H
+#define MULTIRCLUSTERER_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+
+//as fastjet::MaxRap
+const Double_t multiRClustererMaxRap = 1e5;
+
+struct clusteredJet
+{
+  Double_t px, py, pz, e;
+  Double_t pt, eta, phi, m;
+  //Constituents are [constBegin, constBegin+nConst) of multiRClusterer::GetConstituentIndices()
+  Int_t constBegin, nConst;
+};
+
+class multiRClusterer
+{
+ public:
+  multiRClusterer(){};
+  multiRClusterer(std::vector<float> inRVals);
+  ~multiRClusterer(){};
+
+  bool Init(std::vector<float> inRVals);
+
+  //Fill particle list for an event; indices follow insertion order
+  void ClearParticles();
+  void AddParticle(const Double_t px, const Double_t py, const Double_t pz, const Double_t e);
+  Int_t GetNParticles() const;
+  //Shared preprocessing; called by Cluster if needed, exposed so it can be timed separately
+  void PrepareParticles();
+
+  //Inclusive jets w/ pt >= ptMin at radius m_rVals[rI], sorted by decreasing pt
+  bool Cluster(const Int_t rI, const Double_t ptMin, std::vector<clusteredJet>* outJets);
+  //Particle indices of jet constituents, valid until the next Cluster call
+  const std::vector<Int_t>& GetConstituentIndices() const;
+
+ private:
+  std::vector<float> m_rVals;
+  bool m_isPrepared = false;
+
+  //Shared per-event particle preprocessing
+  std::vector<Double_t> m_partPx, m_partPy, m_partPz, m_partE;
+  std::vector<Double_t> m_partRap, m_partPhi, m_partKt2Inv;
+  std::vector<Int_t> m_partTile;
+
+  //Shared tiling
+  Double_t m_tileWidth = 0.0;
+  Double_t m_tileRapMin = 0.0;
+  Int_t m_nTilesRap = 0;
+  Int_t m_nTilesPhi = 0;
+
+  //Per-radius clustering state, index = slot; particle i starts in slot i
+  std::vector<Double_t> m_px, m_py, m_pz, m_e;
+  std::vector<Double_t> m_rap, m_phi, m_kt2Inv;
+  std::vector<Int_t> m_tile, m_tileHead, m_tilePrev, m_tileNext;
+  std::vector<Int_t> m_nn;
+  std::vector<Double_t> m_nnDist, m_diJ;
+  std::vector<Int_t> m_active, m_activePos;
+  std::vector<Int_t> m_constHead, m_constTail, m_constNext;
+  std::vector<Int_t> m_tileMark;
+  std::vector<Int_t> m_neighbourTiles;
+  Int_t m_tileStamp = 0;
+  Int_t m_nTileSteps = 1;
+  Double_t m_r2 = 0.0;
+
+  std::vector<Int_t> m_constituentIndices;
+
+  void SetRapPhiKt2Inv(const Double_t px, const Double_t py, const Double_t pz, const Double_t e, Double_t* rap, Double_t* phi, Double_t* kt2Inv) const;
+  Int_t GetTile(const Double_t rap, const Double_t phi) const;
+  void CollectNeighbourTiles(const Int_t tile);
+  Double_t GetDeltaR2(const Int_t slot1, const Int_t slot2) const;
+  void ComputeNN(const Int_t slot);
+  void UpdateDiJ(const Int_t slot);
+  void InsertInTile(const Int_t slot);
+  void RemoveFromTile(const Int_t slot);
+  void RemoveFromActive(const Int_t slot);
+};
+
+multiRClusterer::multiRClusterer(std::vector<float> inRVals)
+{
+  Init(inRVals);
+  return;
+}
+
+bool multiRClusterer::Init(std::vector<float> inRVals)
+{
+  m_rVals = inRVals;
+  if(m_rVals.size() == 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given empty list of radii. return false" << std::endl;
+    return false;
+  }
+
+  Double_t minR = m_rVals[0];
+  for(unsigned int rI = 0; rI < m_rVals.size(); ++rI){
+    if(m_rVals[rI] <= 0.0){
+      std::cout << __PRETTY_FUNCTION__ << ": given radius '" << m_rVals[rI] << "' must be > 0. return false" << std::endl;
+      m_rVals.clear();
+      return false;
+    }
+    if(m_rVals[rI] < minR) minR = m_rVals[rI];
+  }
+
+  //At least 3 phi tiles so that the +-1 tile neighbourhood never double counts
+  m_nTilesPhi = TMath::Max(3, (Int_t)(2.0*TMath::Pi()/minR));
+  m_tileWidth = 2.0*TMath::Pi()/m_nTilesPhi;
+  m_isPrepared = false;
+
+  return true;
+}
+
+void multiRClusterer::ClearParticles()
+{
+  m_partPx.clear();
+  m_partPy.clear();
+  m_partPz.clear();
+  m_partE.clear();
+  m_isPrepared = false;
+  return;
+}
+
+void multiRClusterer::AddParticle(const Double_t px, const Double_t py, const Double_t pz, const Double_t e)
+{
+  m_partPx.push_back(px);
+  m_partPy.push_back(py);
+  m_partPz.push_back(pz);
+  m_partE.push_back(e);
+  m_isPrepared = false;
+  return;
+}
+
+Int_t multiRClusterer::GetNParticles() const {return (Int_t)m_partPx.size();}
+
+const std::vector<Int_t>& multiRClusterer::GetConstituentIndices() const {return m_constituentIndices;}
+
+//Same conventions as fastjet::PseudoJet::_set_rap_phi; phi in [0, 2pi)
+void multiRClusterer::SetRapPhiKt2Inv(const Double_t px, const Double_t py, const Double_t pz, const Double_t e, Double_t* rap, Double_t* phi, Double_t* kt2Inv) const
+{
+  const Double_t kt2 = px*px + py*py;
+
+  *phi = (kt2 == 0.0) ? 0.0 : std::atan2(py, px);
+  if(*phi < 0.0) *phi += 2.0*TMath::Pi();
+  if(*phi >= 2.0*TMath::Pi()) *phi -= 2.0*TMath::Pi();
+
+  if(e == std::abs(pz) && kt2 == 0.0){
+    *rap = multiRClustererMaxRap + std::abs(pz);
+    if(pz < 0.0) *rap = -(*rap);
+  }
+  else{
+    const Double_t effM2 = TMath::Max(0.0, (e + pz)*(e - pz) - kt2);
+    const Double_t ePlusPz = e + std::abs(pz);
+    *rap = 0.5*std::log((kt2 + effM2)/(ePlusPz*ePlusPz));
+    if(pz > 0.0) *rap = -(*rap);
+  }
+
+  *kt2Inv = kt2 > 1e-300 ? 1.0/kt2 : 1e300;
+  return;
+}
+
+//Shared preprocessing: done once per event regardless of the number of radii
+void multiRClusterer::PrepareParticles()
+{
+  const Int_t nPart = GetNParticles();
+  m_partRap.resize(nPart);
+  m_partPhi.resize(nPart);
+  m_partKt2Inv.resize(nPart);
+  m_partTile.resize(nPart);
+
+  Double_t rapMin = 0.0;
+  Double_t rapMax = 0.0;
+  for(Int_t pI = 0; pI < nPart; ++pI){
+    SetRapPhiKt2Inv(m_partPx[pI], m_partPy[pI], m_partPz[pI], m_partE[pI], &(m_partRap[pI]), &(m_partPhi[pI]), &(m_partKt2Inv[pI]));
+    if(pI == 0 || m_partRap[pI] < rapMin) rapMin = m_partRap[pI];
+    if(pI == 0 || m_partRap[pI] > rapMax) rapMax = m_partRap[pI];
+  }
+
+  //Cap the tiled range; anything beyond lands in the edge tiles, which is still correct
+  const Double_t tileRapCap = 10.0;
+  rapMin = TMath::Max(rapMin, -tileRapCap);
+  rapMax = TMath::Min(rapMax, tileRapCap);
+  if(rapMax < rapMin) rapMax = rapMin;
+
+  m_tileRapMin = rapMin;
+  m_nTilesRap = (Int_t)((rapMax - rapMin)/m_tileWidth) + 1;
+
+  for(Int_t pI = 0; pI < nPart; ++pI){
+    m_partTile[pI] = GetTile(m_partRap[pI], m_partPhi[pI]);
+  }
+
+  m_tileMark.assign(m_nTilesRap*m_nTilesPhi, 0);
+  m_tileStamp = 0;
+  m_isPrepared = true;
+  return;
+}
+
+Int_t multiRClusterer::GetTile(const Double_t rap, const Double_t phi) const
+{
+  Int_t rapPos = 0;
+  if(rap > m_tileRapMin) rapPos = TMath::Min(m_nTilesRap - 1, (Int_t)((rap - m_tileRapMin)/m_tileWidth));
+  Int_t phiPos = TMath::Min(m_nTilesPhi - 1, TMath::Max(0, (Int_t)(phi/m_tileWidth)));
+  return rapPos*m_nTilesPhi + phiPos;
+}
+
+//Fill m_neighbourTiles w/ tiles within m_nTileSteps of tile, skipping any already marked w/ the current stamp
+void multiRClusterer::CollectNeighbourTiles(const Int_t tile)
+{
+  const Int_t rapPos = tile/m_nTilesPhi;
+  const Int_t phiPos = tile%m_nTilesPhi;
+
+  const Int_t rapLow = TMath::Max(0, rapPos - m_nTileSteps);
+  const Int_t rapHigh = TMath::Min(m_nTilesRap - 1, rapPos + m_nTileSteps);
+  Int_t phiLow = phiPos - m_nTileSteps;
+  Int_t phiHigh = phiPos + m_nTileSteps;
+  //Neighbourhood wraps all the way around in phi
+  if(phiHigh - phiLow + 1 >= m_nTilesPhi){
+    phiLow = 0;
+    phiHigh = m_nTilesPhi - 1;
+  }
+
+  for(Int_t rI = rapLow; rI <= rapHigh; ++rI){
+    for(Int_t pI = phiLow; pI <= phiHigh; ++pI){
+      const Int_t neighbourTile = rI*m_nTilesPhi + (pI + m_nTilesPhi)%m_nTilesPhi;
+      if(m_tileMark[neighbourTile] == m_tileStamp) continue;
+      m_tileMark[neighbourTile] = m_tileStamp;
+      m_neighbourTiles.push_back(neighbourTile);
+    }
+  }
+  return;
+}
+
+Double_t multiRClusterer::GetDeltaR2(const Int_t slot1, const Int_t slot2) const
+{
+  const Double_t dRap = m_rap[slot1] - m_rap[slot2];
+  Double_t dPhi = std::abs(m_phi[slot1] - m_phi[slot2]);
+  if(dPhi > TMath::Pi()) dPhi = 2.0*TMath::Pi() - dPhi;
+  return dRap*dRap + dPhi*dPhi;
+}
+
+void multiRClusterer::ComputeNN(const Int_t slot)
+{
+  m_nn[slot] = -1;
+  m_nnDist[slot] = m_r2;
+
+  ++m_tileStamp;
+  m_neighbourTiles.clear();
+  CollectNeighbourTiles(m_tile[slot]);
+
+  for(unsigned int tI = 0; tI < m_neighbourTiles.size(); ++tI){
+    for(Int_t otherSlot = m_tileHead[m_neighbourTiles[tI]]; otherSlot >= 0; otherSlot = m_tileNext[otherSlot]){
+      if(otherSlot == slot) continue;
+      const Double_t dist = GetDeltaR2(slot, otherSlot);
+      if(dist < m_nnDist[slot]){
+	m_nnDist[slot] = dist;
+	m_nn[slot] = otherSlot;
+      }
+    }
+  }
+  return;
+}
+
+//Anti-kt: d_ij = min(1/kt_i^2, 1/kt_j^2) dR_ij^2/R^2, d_iB = 1/kt_i^2; both kept scaled by R^2
+void multiRClusterer::UpdateDiJ(const Int_t slot)
+{
+  Double_t kt2Inv = m_kt2Inv[slot];
+  if(m_nn[slot] >= 0) kt2Inv = TMath::Min(kt2Inv, m_kt2Inv[m_nn[slot]]);
+  m_diJ[slot] = kt2Inv*m_nnDist[slot];
+  return;
+}
+
+void multiRClusterer::InsertInTile(const Int_t slot)
+{
+  const Int_t tile = m_tile[slot];
+  m_tilePrev[slot] = -1;
+  m_tileNext[slot] = m_tileHead[tile];
+  if(m_tileHead[tile] >= 0) m_tilePrev[m_tileHead[tile]] = slot;
+  m_tileHead[tile] = slot;
+  return;
+}
+
+void multiRClusterer::RemoveFromTile(const Int_t slot)
+{
+  if(m_tilePrev[slot] >= 0) m_tileNext[m_tilePrev[slot]] = m_tileNext[slot];
+  else m_tileHead[m_tile[slot]] = m_tileNext[slot];
+  if(m_tileNext[slot] >= 0) m_tilePrev[m_tileNext[slot]] = m_tilePrev[slot];
+  m_tilePrev[slot] = -1;
+  m_tileNext[slot] = -1;
+  return;
+}
+
+void multiRClusterer::RemoveFromActive(const Int_t slot)
+{
+  const Int_t pos = m_activePos[slot];
+  const Int_t lastSlot = m_active.back();
+  m_active[pos] = lastSlot;
+  m_activePos[lastSlot] = pos;
+  m_active.pop_back();
+  m_activePos[slot] = -1;
+  return;
+}
+
+bool multiRClusterer::Cluster(const Int_t rI, const Double_t ptMin, std::vector<clusteredJet>* outJets)
+{
+  outJets->clear();
+  m_constituentIndices.clear();
+  if(rI < 0 || rI >= (Int_t)m_rVals.size()){
+    std::cout << __PRETTY_FUNCTION__ << ": given rI '" << rI << "' outside [0, " << m_rVals.size() << "). return false" << std::endl;
+    return false;
+  }
+
+  const Int_t nPart = GetNParticles();
+  if(nPart == 0) return true;
+  if(!m_isPrepared) PrepareParticles();
+
+  const Double_t rVal = m_rVals[rI];
+  m_r2 = rVal*rVal;
+  m_nTileSteps = (Int_t)std::ceil(rVal/m_tileWidth - 1e-9);
+  if(m_nTileSteps < 1) m_nTileSteps = 1;
+
+  //Per-radius state starts from the shared preprocessing
+  m_px = m_partPx;
+  m_py = m_partPy;
+  m_pz = m_partPz;
+  m_e = m_partE;
+  m_rap = m_partRap;
+  m_phi = m_partPhi;
+  m_kt2Inv = m_partKt2Inv;
+  m_tile = m_partTile;
+
+  m_tileHead.assign(m_nTilesRap*m_nTilesPhi, -1);
+  m_tilePrev.assign(nPart, -1);
+  m_tileNext.assign(nPart, -1);
+  m_nn.assign(nPart, -1);
+  m_nnDist.assign(nPart, m_r2);
+  m_diJ.assign(nPart, 0.0);
+  m_active.resize(nPart);
+  m_activePos.resize(nPart);
+  m_constHead.resize(nPart);
+  m_constTail.resize(nPart);
+  m_constNext.assign(nPart, -1);
+
+  for(Int_t pI = 0; pI < nPart; ++pI){
+    m_active[pI] = pI;
+    m_activePos[pI] = pI;
+    m_constHead[pI] = pI;
+    m_constTail[pI] = pI;
+    InsertInTile(pI);
+  }
+  for(Int_t pI = 0; pI < nPart; ++pI){
+    ComputeNN(pI);
+    UpdateDiJ(pI);
+  }
+
+  const Double_t ptMin2 = ptMin*ptMin;
+  std::vector<Int_t> updateSlots;
+
+  while(m_active.size() != 0){
+    //Smallest distance among active jets
+    Int_t slotA = m_active[0];
+    for(unsigned int aI = 1; aI < m_active.size(); ++aI){
+      if(m_diJ[m_active[aI]] < m_diJ[slotA]) slotA = m_active[aI];
+    }
+    const Int_t slotB = m_nn[slotA];
+
+    ++m_tileStamp;
+    m_neighbourTiles.clear();
+    CollectNeighbourTiles(m_tile[slotA]);
+
+    if(slotB >= 0){
+      //Recombine b into a, E-scheme
+      CollectNeighbourTiles(m_tile[slotB]);
+      RemoveFromTile(slotA);
+      RemoveFromTile(slotB);
+      RemoveFromActive(slotB);
+
+      m_px[slotA] += m_px[slotB];
+      m_py[slotA] += m_py[slotB];
+      m_pz[slotA] += m_pz[slotB];
+      m_e[slotA] += m_e[slotB];
+      SetRapPhiKt2Inv(m_px[slotA], m_py[slotA], m_pz[slotA], m_e[slotA], &(m_rap[slotA]), &(m_phi[slotA]), &(m_kt2Inv[slotA]));
+      m_tile[slotA] = GetTile(m_rap[slotA], m_phi[slotA]);
+      InsertInTile(slotA);
+      CollectNeighbourTiles(m_tile[slotA]);
+
+      m_constNext[m_constTail[slotA]] = m_constHead[slotB];
+      m_constTail[slotA] = m_constTail[slotB];
+    }
+    else{
+      //Beam recombination -> final jet
+      RemoveFromTile(slotA);
+      RemoveFromActive(slotA);
+
+      const Double_t pt2 = m_px[slotA]*m_px[slotA] + m_py[slotA]*m_py[slotA];
+      if(pt2 >= ptMin2){
+	clusteredJet jet;
+	jet.px = m_px[slotA];
+	jet.py = m_py[slotA];
+	jet.pz = m_pz[slotA];
+	jet.e = m_e[slotA];
+	jet.pt = std::sqrt(pt2);
+	if(pt2 != 0.0) jet.eta = std::asinh(m_pz[slotA]/jet.pt);
+	else jet.eta = m_pz[slotA] >= 0.0 ? multiRClustererMaxRap : -multiRClustererMaxRap;
+	jet.phi = m_phi[slotA];
+	jet.m = (m_e[slotA] + m_pz[slotA])*(m_e[slotA] - m_pz[slotA]) - pt2;
+	jet.m = jet.m < 0.0 ? -std::sqrt(-jet.m) : std::sqrt(jet.m);
+	jet.constBegin = (Int_t)m_constituentIndices.size();
+	jet.nConst = 0;
+	for(Int_t cI = m_constHead[slotA]; cI >= 0; cI = m_constNext[cI]){
+	  m_constituentIndices.push_back(cI);
+	  ++jet.nConst;
+	}
+	outJets->push_back(jet);
+      }
+    }
+
+    //Only jets in the touched tiles can have had a or b as nearest neighbour, or gain the new a as one
+    updateSlots.clear();
+    for(unsigned int tI = 0; tI < m_neighbourTiles.size(); ++tI){
+      for(Int_t slot = m_tileHead[m_neighbourTiles[tI]]; slot >= 0; slot = m_tileNext[slot]){
+	updateSlots.push_back(slot);
+      }
+    }
+
+    for(unsigned int uI = 0; uI < updateSlots.size(); ++uI){
+      const Int_t slot = updateSlots[uI];
+      if(slot == slotA) ComputeNN(slot);
+      //slotB -1 (beam) must not match the jets w/o a neighbour, m_nn -1 as well
+      else if(m_nn[slot] == slotA || (slotB >= 0 && m_nn[slot] == slotB)) ComputeNN(slot);
+      else if(slotB >= 0){
+	const Double_t dist = GetDeltaR2(slot, slotA);
+	if(dist < m_nnDist[slot]){
+	  m_nnDist[slot] = dist;
+	  m_nn[slot] = slotA;
+	}
+      }
+      UpdateDiJ(slot);
+    }
+  }
+
+  //sorted_by_pt equivalent
+  std::sort(outJets->begin(), outJets->end(), [](const clusteredJet& jet1, const clusteredJet& jet2){return jet1.pt > jet2.pt;});
+
+  return true;
+}
+
+#endif
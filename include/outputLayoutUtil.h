@@ -0,0 +1,69 @@
+#ifndef OUTPUTLAYOUTUTIL_H
+#define OUTPUTLAYOUTUTIL_H
+
+//c+cpp
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "Compression.h"
+#include "TFile.h"
+#include "TTree.h"
+
+//local
+#include "include/stringUtil.h"
+
+//Output layout steering shared by writers: COMPRESSIONALGO (DEFAULT, ZLIB, LZMA, LZ4, ZSTD), COMPRESSIONLEVEL (0-9),
+//BASKETSIZE (bytes per branch basket) and AUTOFLUSH (TTree::SetAutoFlush convention, > 0 entries, < 0 bytes per cluster)
+//DEFAULT keeps whatever ROOT would use for a new TFile
+
+inline std::vector<std::string> getCompressionAlgoStrs(){return {"DEFAULT", "ZLIB", "LZMA", "LZ4", "ZSTD"};}
+
+//Returns -1 for unknown strings
+inline Int_t getCompressionAlgo(const std::string inAlgoStr)
+{
+  const std::string algoStr = returnAllCapsString(inAlgoStr);
+  if(isStrSame(algoStr, "DEFAULT")) return ROOT::RCompressionSetting::EAlgorithm::kUseGlobal;
+  if(isStrSame(algoStr, "ZLIB")) return ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+  if(isStrSame(algoStr, "LZMA")) return ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+  if(isStrSame(algoStr, "LZ4")) return ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+  if(isStrSame(algoStr, "ZSTD")) return ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+  return -1;
+}
+
+inline bool checkOutputLayout(const std::string algoStr, const Int_t compLevel, const Int_t basketSize)
+{
+  if(getCompressionAlgo(algoStr) < 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given COMPRESSIONALGO '" << algoStr << "' is not one of " << vectToStrComma(getCompressionAlgoStrs()) << ". return false" << std::endl;
+    return false;
+  }
+  if(compLevel < 0 || compLevel > 9){
+    std::cout << __PRETTY_FUNCTION__ << ": given COMPRESSIONLEVEL '" << compLevel << "' must be in [0, 9]. return false" << std::endl;
+    return false;
+  }
+  if(basketSize <= 0){
+    std::cout << __PRETTY_FUNCTION__ << ": given BASKETSIZE '" << basketSize << "' must be > 0. return false" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+inline void setFileCompression(TFile* outFile_p, const std::string algoStr, const Int_t compLevel)
+{
+  const Int_t compAlgo = getCompressionAlgo(algoStr);
+  if(compAlgo <= 0) return;
+
+  outFile_p->SetCompressionSettings(ROOT::CompressionSettings((ROOT::RCompressionSetting::EAlgorithm::EValues)compAlgo, compLevel));
+  return;
+}
+
+//Call after all branches of inTree_p are declared; branches added later need their own SetBasketSize
+inline void setTreeLayout(TTree* inTree_p, const Int_t basketSize, const Long64_t autoFlush)
+{
+  inTree_p->SetBasketSize("*", basketSize);
+  inTree_p->SetAutoFlush(autoFlush);
+  return;
+}
+
+#endif
@@ -0,0 +1,157 @@
+//Final-state particle selection of createPYTHIA: PARTABSETAMAX, PARTPTMIN, DOCHARGEDONLY and PARTEXCLUDEIDS (comma separated
+//PDG ids, signed, so list e.g. -12 separately to drop antineutrinos too)
+//Cuts are meant to be applied cheapest first: species from a table indexed by id, charge, pt, then eta (a log) only for the
+//survivors; accepted particles go into selectedParticles columns that are reused from event to event
+
+#ifndef PARTICLESELECTOR_H
+#define PARTICLESELECTOR_H
+
+//c+cpp
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//ROOT
+#include "TEnv.h"
+#include "TMath.h"
+
+//local
+#include "include/stringUtil.h"
+#include "include/tenvUtil.h"
+
+//Per event columns of the accepted particles; Clear() keeps the capacity, so steady state events allocate nothing
+struct selectedParticles
+{
+  std::vector<Float_t> pt, eta, phi, m;
+  std::vector<Int_t> id;
+  std::vector<Double_t> px, py, pz, e;
+
+  void Clear();
+  void Add(const Float_t inPt, const Float_t inEta, const Float_t inPhi, const Float_t inM, const Int_t inId, const Double_t inPx, const Double_t inPy, const Double_t inPz, const Double_t inE);
+  Int_t GetN() const;
+};
+
+void selectedParticles::Clear()
+{
+  pt.clear();
+  eta.clear();
+  phi.clear();
+  m.clear();
+  id.clear();
+  px.clear();
+  py.clear();
+  pz.clear();
+  e.clear();
+  return;
+}
+
+void selectedParticles::Add(const Float_t inPt, const Float_t inEta, const Float_t inPhi, const Float_t inM, const Int_t inId, const Double_t inPx, const Double_t inPy, const Double_t inPz, const Double_t inE)
+{
+  pt.push_back(inPt);
+  eta.push_back(inEta);
+  phi.push_back(inPhi);
+  m.push_back(inM);
+  id.push_back(inId);
+  px.push_back(inPx);
+  py.push_back(inPy);
+  pz.push_back(inPz);
+  e.push_back(inE);
+  return;
+}
+
+Int_t selectedParticles::GetN() const {return (Int_t)pt.size();}
+
+//Defaults reproduce the original hard-coded selection: |eta| <= 5, no pt cut, all charges, ids 12, 14, 16 dropped
+inline std::vector<std::string> getParticleSelectionParams(){return {"PARTABSETAMAX", "PARTPTMIN", "DOCHARGEDONLY", "PARTEXCLUDEIDS"};}
+const Float_t defaultPartAbsEtaMax = 5.0;
+const Float_t defaultPartPtMin = 0.0;
+const Bool_t defaultDoChargedOnly = false;
+const std::string defaultPartExcludeIds = "12,14,16";
+
+inline void checkParticleSelectionParams(TEnv* inConfig_p)
+{
+  checkTEnvParam("PARTABSETAMAX", defaultPartAbsEtaMax, inConfig_p);
+  checkTEnvParam("PARTPTMIN", defaultPartPtMin, inConfig_p);
+  checkTEnvParam("DOCHARGEDONLY", defaultDoChargedOnly, inConfig_p);
+  checkTEnvParam("PARTEXCLUDEIDS", defaultPartExcludeIds.c_str(), inConfig_p);
+  return;
+}
+
+class particleSelector
+{
+ public:
+  particleSelector(){};
+  ~particleSelector(){};
+
+  bool Init(const Float_t absEtaMax, const Float_t ptMin, const Bool_t doChargedOnly, const std::vector<Int_t>& excludeIds);
+  //Grab + validate the selection params of inConfig_p
+  bool Init(TEnv* inConfig_p);
+
+  //Species cut alone, no kinematics needed
+  bool AcceptId(const Int_t id) const;
+  bool AcceptPt(const Double_t pt) const;
+  bool AcceptEta(const Double_t eta) const;
+
+  Float_t GetAbsEtaMax() const;
+  Bool_t GetDoChargedOnly() const;
+
+ private:
+  Float_t m_absEtaMax = defaultPartAbsEtaMax;
+  Float_t m_ptMin = defaultPartPtMin;
+  Bool_t m_doChargedOnly = defaultDoChargedOnly;
+  //Exclusion flag per id in [-m_maxTableId, m_maxTableId] (all hadrons + leptons); rarer ids, e.g. BSM, fall back to a search
+  static const Int_t m_maxTableId = 9999;
+  std::vector<UChar_t> m_isExcluded;
+  std::vector<Int_t> m_excludeIdsOutOfTable;
+};
+
+bool particleSelector::Init(const Float_t absEtaMax, const Float_t ptMin, const Bool_t doChargedOnly, const std::vector<Int_t>& excludeIds)
+{
+  if(absEtaMax <= 0.0 || ptMin < 0.0){
+    std::cout << __PRETTY_FUNCTION__ << ": given PARTABSETAMAX '" << absEtaMax << "' must be > 0 and PARTPTMIN '" << ptMin << "' >= 0. return false" << std::endl;
+    return false;
+  }
+
+  m_absEtaMax = absEtaMax;
+  m_ptMin = ptMin;
+  m_doChargedOnly = doChargedOnly;
+
+  m_isExcluded.assign(2*m_maxTableId + 1, 0);
+  m_excludeIdsOutOfTable.clear();
+  for(unsigned int iI = 0; iI < excludeIds.size(); ++iI){
+    if(TMath::Abs(excludeIds[iI]) <= m_maxTableId) m_isExcluded[excludeIds[iI] + m_maxTableId] = 1;
+    else m_excludeIdsOutOfTable.push_back(excludeIds[iI]);
+  }
+  return true;
+}
+
+bool particleSelector::Init(TEnv* inConfig_p)
+{
+  const std::string excludeIdsStr = inConfig_p->GetValue("PARTEXCLUDEIDS", defaultPartExcludeIds.c_str());
+  std::vector<Int_t> excludeIds;
+  std::vector<std::string> excludeIdStrs = commaSepStringToVect(excludeIdsStr);
+  for(unsigned int iI = 0; iI < excludeIdStrs.size(); ++iI){
+    if(excludeIdStrs[iI].size() == 0 || !isStrInt(excludeIdStrs[iI])){
+      std::cout << __PRETTY_FUNCTION__ << ": given PARTEXCLUDEIDS '" << excludeIdsStr << "' must be a comma separated list of integer ids. return false" << std::endl;
+      return false;
+    }
+    excludeIds.push_back(std::stoi(excludeIdStrs[iI]));
+  }
+
+  return Init(inConfig_p->GetValue("PARTABSETAMAX", defaultPartAbsEtaMax), inConfig_p->GetValue("PARTPTMIN", defaultPartPtMin), inConfig_p->GetValue("DOCHARGEDONLY", defaultDoChargedOnly), excludeIds);
+}
+
+bool particleSelector::AcceptId(const Int_t id) const
+{
+  if(id >= -m_maxTableId && id <= m_maxTableId) return m_isExcluded[id + m_maxTableId] == 0;
+  return std::find(m_excludeIdsOutOfTable.begin(), m_excludeIdsOutOfTable.end(), id) == m_excludeIdsOutOfTable.end();
+}
+
+bool particleSelector::AcceptPt(const Double_t pt) const {return pt >= m_ptMin;}
+bool particleSelector::AcceptEta(const Double_t eta) const {return TMath::Abs(eta) <= m_absEtaMax;}
+
+Float_t particleSelector::GetAbsEtaMax() const {return m_absEtaMax;}
+Bool_t particleSelector::GetDoChargedOnly() const {return m_doChargedOnly;}
+
+#endif
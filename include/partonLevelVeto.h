@@ -0,0 +1,108 @@
+//Early event veto for createPYTHIA (DOPARTONVETO): a Pythia8 UserHooks that estimates the leading jet pt from the final
+//partons, before hadronization, and vetoes events that cannot give a jet above JTPTMIN
+//Estimate: for each parton seed w/ |eta| <= absEtaMax, the pt of the four-vector sum of all final partons within rParam
+//of it; seeds are tried in decreasing pt order and the first estimate >= ptMin accepts the event
+//Hadronization + the underlying event move jet pt by a few GeV, so ptMin should sit safely below JTPTMIN (PARTONVETOPTFRAC)
+
+#ifndef PARTONLEVELVETO_H
+#define PARTONLEVELVETO_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+
+//PYTHIA
+#include "Pythia8/Pythia.h"
+
+class partonLevelJetVeto : public Pythia8::UserHooks
+{
+ public:
+  partonLevelJetVeto(const Double_t ptMin, const Double_t rParam, const Double_t absEtaMax);
+  ~partonLevelJetVeto(){};
+
+  bool canVetoPartonLevel();
+  bool doVetoPartonLevel(const Pythia8::Event& event);
+
+  //Counts all events seen + vetoed since construction
+  ULong64_t GetNChecked() const;
+  ULong64_t GetNVetoed() const;
+
+ private:
+  Double_t m_ptMin = 0.0;
+  Double_t m_rParam2 = 0.0;
+  Double_t m_absEtaMax = 0.0;
+  ULong64_t m_nChecked = 0;
+  ULong64_t m_nVetoed = 0;
+
+  //Final partons of the current event, reused from event to event
+  std::vector<Double_t> m_px, m_py, m_pt, m_eta, m_phi;
+  std::vector<Int_t> m_order;
+};
+
+partonLevelJetVeto::partonLevelJetVeto(const Double_t ptMin, const Double_t rParam, const Double_t absEtaMax)
+{
+  m_ptMin = ptMin;
+  m_rParam2 = rParam*rParam;
+  m_absEtaMax = absEtaMax;
+  return;
+}
+
+bool partonLevelJetVeto::canVetoPartonLevel(){return true;}
+
+bool partonLevelJetVeto::doVetoPartonLevel(const Pythia8::Event& event)
+{
+  ++m_nChecked;
+
+  m_px.clear();
+  m_py.clear();
+  m_pt.clear();
+  m_eta.clear();
+  m_phi.clear();
+  m_order.clear();
+  for(int i = 0; i < event.size(); ++i){
+    if(!event[i].isFinal()) continue;
+    //Partons + anything else final at this stage (leptons, photons) can end up in a jet
+    const Double_t pt = event[i].pT();
+    if(pt <= 0.0) continue;
+
+    m_order.push_back(m_pt.size());
+    m_px.push_back(event[i].px());
+    m_py.push_back(event[i].py());
+    m_pt.push_back(pt);
+    m_eta.push_back(event[i].eta());
+    m_phi.push_back(event[i].phi());
+  }
+
+  std::sort(m_order.begin(), m_order.end(), [this](const Int_t a, const Int_t b){return m_pt[a] > m_pt[b];});
+
+  for(unsigned int sI = 0; sI < m_order.size(); ++sI){
+    const Int_t seedPos = m_order[sI];
+    if(TMath::Abs(m_eta[seedPos]) > m_absEtaMax) continue;
+
+    Double_t sumPx = 0.0;
+    Double_t sumPy = 0.0;
+    for(unsigned int pI = 0; pI < m_pt.size(); ++pI){
+      const Double_t dEta = m_eta[pI] - m_eta[seedPos];
+      Double_t dPhi = TMath::Abs(m_phi[pI] - m_phi[seedPos]);
+      if(dPhi > TMath::Pi()) dPhi = 2.0*TMath::Pi() - dPhi;
+      if(dEta*dEta + dPhi*dPhi > m_rParam2) continue;
+
+      sumPx += m_px[pI];
+      sumPy += m_py[pI];
+    }
+
+    if(std::sqrt(sumPx*sumPx + sumPy*sumPy) >= m_ptMin) return false;
+  }
+
+  ++m_nVetoed;
+  return true;
+}
+
+ULong64_t partonLevelJetVeto::GetNChecked() const {return m_nChecked;}
+ULong64_t partonLevelJetVeto::GetNVetoed() const {return m_nVetoed;}
+
+#endif
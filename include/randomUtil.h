@@ -0,0 +1,34 @@
+#ifndef RANDOMUTIL_H
+#define RANDOMUTIL_H
+
+//ROOT
+#include "TMath.h"
+
+//splitmix64 finalizer - cheap, stateless 64-bit mixing used to derive decorrelated seeds from a base seed + indices
+inline ULong64_t splitMix64(ULong64_t inVal)
+{
+  inVal += 0x9E3779B97F4A7C15ULL;
+  inVal = (inVal ^ (inVal >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  inVal = (inVal ^ (inVal >> 27)) * 0x94D049BB133111EBULL;
+  return inVal ^ (inVal >> 31);
+}
+
+//Deterministic seed for stream (index1, index2) of a given base seed
+//Return value is within [1, 900000000], the valid range of PYTHIA8 Random:seed
+inline Int_t getDerivedSeed(const Int_t baseSeed, const Int_t index1, const Int_t index2 = 0)
+{
+  const ULong64_t maxPythiaSeed = 900000000ULL;
+  ULong64_t hashVal = splitMix64((ULong64_t)((UInt_t)baseSeed));
+  hashVal = splitMix64(hashVal ^ (ULong64_t)((UInt_t)index1));
+  hashVal = splitMix64(hashVal ^ (((ULong64_t)((UInt_t)index2)) << 32));
+  return (Int_t)(hashVal%maxPythiaSeed) + 1;
+}
+
+//Counter-based uniform in [0, 1): entry counter of the stream keyed by key, from the top 53 bits of the hash
+//Needs no state, so any (key, counter) can be drawn in any order + on any thread w/ the same result
+inline Double_t getCounterUniform(const ULong64_t key, const ULong64_t counter)
+{
+  return (splitMix64(key ^ splitMix64(counter)) >> 11)*(1.0/9007199254740992.0);
+}
+
+#endif
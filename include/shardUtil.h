@@ -0,0 +1,30 @@
+#ifndef SHARDUTIL_H
+#define SHARDUTIL_H
+
+//c+cpp
+#include <string>
+
+//ROOT
+#include "TMath.h"
+
+//local
+#include "include/stringUtil.h"
+
+//Shard shardIndex of nShards covers global events [first, first+n); ranges are contiguous and cover nEventsTotal exactly
+inline ULong64_t getShardFirstEvent(const ULong64_t nEventsTotal, const Int_t nShards, const Int_t shardIndex)
+{
+  return (nEventsTotal/nShards)*shardIndex + TMath::Min((ULong64_t)shardIndex, nEventsTotal%nShards);
+}
+
+inline ULong64_t getShardNEvents(const ULong64_t nEventsTotal, const Int_t nShards, const Int_t shardIndex)
+{
+  return getShardFirstEvent(nEventsTotal, nShards, shardIndex+1) - getShardFirstEvent(nEventsTotal, nShards, shardIndex);
+}
+
+//e.g. basicPYTHIA.root -> basicPYTHIA_Shard3Of8.root
+inline std::string getShardFileName(const std::string inFileName, const Int_t shardIndex, const Int_t nShards)
+{
+  return rootFileNameProc(inFileName, {"Shard" + std::to_string(shardIndex) + "Of" + std::to_string(nShards)});
+}
+
+#endif
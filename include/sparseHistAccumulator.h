@@ -0,0 +1,332 @@
+//Sparse N-dimensional histogram w/ sumw + sumw2, storage only for the bins that were filled
+//Per axis, bin 0 is the underflow + nBins+1 the overflow, as ROOT; the global bin is the axis bins in mixed radix
+//(axis 0 fastest) + an open-addressing hash table maps it to a slot of flat, fill-ordered bin arrays, so a fill is one
+//arithmetic (uniform axis) or binary search (variable axis) bin lookup per axis + ~1 probe, and memory, Add + writing
+//scale w/ the filled bins instead of the full grid
+//Results convert to a THnSparse w/ the same binning at the end, contents + errors identical to THnSparse::Fill
+
+#ifndef SPARSEHISTACCUMULATOR_H
+#define SPARSEHISTACCUMULATOR_H
+
+//c+cpp
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//ROOT
+#include "THnSparse.h"
+#include "TMath.h"
+
+//local
+#include "include/randomUtil.h"
+
+//Hash table size of an empty accumulator + the key of a free table slot, never a valid global bin
+const Long64_t sparseInitTableSize = 1024;
+const ULong64_t sparseEmptyKey = ~0ULL;
+
+class sparseHistAccumulator
+{
+ public:
+  sparseHistAccumulator(){};
+  ~sparseHistAccumulator(){};
+
+  //binEdges[d] are the nBins_d+1 ascending edges of axis d; equal-width axes are binned arithmetically, others by search
+  bool Init(const std::vector<std::vector<Double_t> >& binEdges);
+  //Drops all filled bins + shrinks the table back, keeping the axes
+  void Reset();
+
+  //x has one value per axis
+  void Fill(const Double_t* x, const Double_t weight = 1.0);
+  //As THnBase::Add(h, scale): contents scaled, errors by scale^2, entries not
+  void Add(const sparseHistAccumulator& inAcc, const Double_t scale = 1.0);
+
+  //Sets contents, errors + entries of an empty histogram w/ the same binning, allocating only the filled bins
+  bool WriteToTHn(THnBase* inHist_p) const;
+  //Inverse of WriteToTHn, e.g. to continue filling a histogram from an earlier job; replaces the current contents
+  bool ReadFromTHn(const THnBase* inHist_p);
+
+  //Axis bins as THnBase::GetBin (0 underflow, nBins+1 overflow); 0 for bins never filled
+  Double_t GetBinContent(const Int_t* coords) const;
+  Double_t GetBinError2(const Int_t* coords) const;
+  Int_t GetNDim() const;
+  Long64_t GetNFilledBins() const;
+  Double_t GetEntries() const;
+  //Heap bytes of the bin arrays + hash table
+  Long64_t GetMemoryBytes() const;
+
+ private:
+  Int_t m_nDim = 0;
+  std::vector<Int_t> m_nBins;
+  std::vector<std::vector<Double_t> > m_binEdges;
+  std::vector<Bool_t> m_isUniform;
+  std::vector<Double_t> m_axisLow, m_axisInvWidth;
+  //Global bin = sum over axes of bin_d*m_strides[d]
+  std::vector<ULong64_t> m_strides;
+
+  //Filled bins in fill order
+  std::vector<ULong64_t> m_binKeys;
+  std::vector<Double_t> m_sumw, m_sumw2;
+  Double_t m_entries = 0.0;
+
+  //Power-of-two table, linear probing, at most half full; m_tableKeys[h] == sparseEmptyKey marks a free slot
+  std::vector<ULong64_t> m_tableKeys;
+  std::vector<Long64_t> m_tableSlots;
+  ULong64_t m_tableMask = 0;
+
+  Int_t GetAxisBin(const Int_t axisPos, const Double_t xVal) const;
+  ULong64_t GetBinKey(const Int_t* coords) const;
+  //Slot of binKey, -1 if never filled
+  Long64_t Find(const ULong64_t binKey) const;
+  Long64_t FindOrInsert(const ULong64_t binKey);
+  void Rehash(const Long64_t tableSize);
+};
+
+bool sparseHistAccumulator::Init(const std::vector<std::vector<Double_t> >& binEdges)
+{
+  if(binEdges.empty()){
+    std::cout << __PRETTY_FUNCTION__ << ": no axes given. return false" << std::endl;
+    return false;
+  }
+
+  m_nDim = (Int_t)binEdges.size();
+  m_nBins.assign(m_nDim, 0);
+  m_binEdges = binEdges;
+  m_isUniform.assign(m_nDim, true);
+  m_axisLow.assign(m_nDim, 0.0);
+  m_axisInvWidth.assign(m_nDim, 0.0);
+  m_strides.assign(m_nDim, 1);
+
+  //Global bins must stay below sparseEmptyKey; checked in doubles so the product cannot wrap
+  Double_t nGlobalBins = 1.0;
+  for(Int_t dI = 0; dI < m_nDim; ++dI){
+    const std::vector<Double_t>& edges = binEdges[dI];
+    if(edges.size() < 2){
+      std::cout << __PRETTY_FUNCTION__ << ": axis " << dI << " has " << edges.size() << " edges, needs >= 2. return false" << std::endl;
+      return false;
+    }
+    for(unsigned int eI = 1; eI < edges.size(); ++eI){
+      if(edges[eI] > edges[eI-1]) continue;
+      std::cout << __PRETTY_FUNCTION__ << ": axis " << dI << " edges are not ascending at edge " << eI << ". return false" << std::endl;
+      return false;
+    }
+
+    const Int_t nBins = (Int_t)edges.size() - 1;
+    m_nBins[dI] = nBins;
+    m_axisLow[dI] = edges[0];
+    m_axisInvWidth[dI] = nBins/(edges[nBins] - edges[0]);
+    const Double_t binWidth = (edges[nBins] - edges[0])/nBins;
+    //Equal width up to float rounding, e.g. getLinBins edges; the arithmetic guess is corrected by one bin either way
+    for(Int_t bI = 1; bI < nBins; ++bI){
+      if(std::fabs(edges[bI] - (edges[0] + bI*binWidth)) <= 1.0e-6*std::fabs(binWidth)) continue;
+      m_isUniform[dI] = false;
+      break;
+    }
+
+    if(dI > 0) m_strides[dI] = m_strides[dI-1]*(ULong64_t)(m_nBins[dI-1] + 2);
+    nGlobalBins *= (Double_t)(nBins + 2);
+  }
+  if(nGlobalBins >= 9.0e18){
+    std::cout << __PRETTY_FUNCTION__ << ": " << nGlobalBins << " global bins (under/overflow included) exceed the 64-bit bin index. return false" << std::endl;
+    return false;
+  }
+
+  Reset();
+  return true;
+}
+
+void sparseHistAccumulator::Reset()
+{
+  m_binKeys.clear();
+  m_sumw.clear();
+  m_sumw2.clear();
+  m_entries = 0.0;
+  m_tableKeys.assign(sparseInitTableSize, sparseEmptyKey);
+  m_tableSlots.assign(sparseInitTableSize, -1);
+  m_tableMask = sparseInitTableSize - 1;
+  return;
+}
+
+//As TAxis::FindBin on the same edges; NaN goes to the underflow
+Int_t sparseHistAccumulator::GetAxisBin(const Int_t axisPos, const Double_t xVal) const
+{
+  const std::vector<Double_t>& edges = m_binEdges[axisPos];
+  const Int_t nBins = m_nBins[axisPos];
+  if(!(xVal >= edges[0])) return 0;
+  if(xVal >= edges[nBins]) return nBins + 1;
+  if(!m_isUniform[axisPos]) return (Int_t)(std::upper_bound(edges.begin(), edges.end(), xVal) - edges.begin());
+
+  //Arithmetic guess, corrected against the exact edges for values rounding across one
+  Int_t binPos = (Int_t)((xVal - m_axisLow[axisPos])*m_axisInvWidth[axisPos]) + 1;
+  binPos = TMath::Max(1, TMath::Min(nBins, binPos));
+  if(xVal < edges[binPos-1]) --binPos;
+  else if(xVal >= edges[binPos]) ++binPos;
+  return binPos;
+}
+
+ULong64_t sparseHistAccumulator::GetBinKey(const Int_t* coords) const
+{
+  ULong64_t binKey = 0;
+  for(Int_t dI = 0; dI < m_nDim; ++dI){
+    binKey += (ULong64_t)coords[dI]*m_strides[dI];
+  }
+  return binKey;
+}
+
+Long64_t sparseHistAccumulator::Find(const ULong64_t binKey) const
+{
+  ULong64_t tablePos = splitMix64(binKey) & m_tableMask;
+  while(m_tableKeys[tablePos] != binKey){
+    if(m_tableKeys[tablePos] == sparseEmptyKey) return -1;
+    tablePos = (tablePos + 1) & m_tableMask;
+  }
+  return m_tableSlots[tablePos];
+}
+
+Long64_t sparseHistAccumulator::FindOrInsert(const ULong64_t binKey)
+{
+  ULong64_t tablePos = splitMix64(binKey) & m_tableMask;
+  while(m_tableKeys[tablePos] != binKey){
+    if(m_tableKeys[tablePos] == sparseEmptyKey){
+      const Long64_t slotPos = (Long64_t)m_binKeys.size();
+      m_tableKeys[tablePos] = binKey;
+      m_tableSlots[tablePos] = slotPos;
+      m_binKeys.push_back(binKey);
+      m_sumw.push_back(0.0);
+      m_sumw2.push_back(0.0);
+      if(2*(ULong64_t)m_binKeys.size() > m_tableMask + 1) Rehash(2*(Long64_t)(m_tableMask + 1));
+      return slotPos;
+    }
+    tablePos = (tablePos + 1) & m_tableMask;
+  }
+  return m_tableSlots[tablePos];
+}
+
+//Slots keep their positions, only the table is rebuilt
+void sparseHistAccumulator::Rehash(const Long64_t tableSize)
+{
+  m_tableKeys.assign(tableSize, sparseEmptyKey);
+  m_tableSlots.assign(tableSize, -1);
+  m_tableMask = (ULong64_t)tableSize - 1;
+  for(unsigned int sI = 0; sI < m_binKeys.size(); ++sI){
+    ULong64_t tablePos = splitMix64(m_binKeys[sI]) & m_tableMask;
+    while(m_tableKeys[tablePos] != sparseEmptyKey){
+      tablePos = (tablePos + 1) & m_tableMask;
+    }
+    m_tableKeys[tablePos] = m_binKeys[sI];
+    m_tableSlots[tablePos] = sI;
+  }
+  return;
+}
+
+void sparseHistAccumulator::Fill(const Double_t* x, const Double_t weight)
+{
+  ULong64_t binKey = 0;
+  for(Int_t dI = 0; dI < m_nDim; ++dI){
+    binKey += (ULong64_t)GetAxisBin(dI, x[dI])*m_strides[dI];
+  }
+
+  const Long64_t slotPos = FindOrInsert(binKey);
+  m_sumw[slotPos] += weight;
+  m_sumw2[slotPos] += weight*weight;
+  m_entries += 1.0;
+  return;
+}
+
+void sparseHistAccumulator::Add(const sparseHistAccumulator& inAcc, const Double_t scale)
+{
+  if(inAcc.m_nBins != m_nBins || inAcc.m_binEdges != m_binEdges){
+    std::cout << __PRETTY_FUNCTION__ << ": binning mismatch. return" << std::endl;
+    return;
+  }
+
+  const Double_t scale2 = scale*scale;
+  for(unsigned int sI = 0; sI < inAcc.m_binKeys.size(); ++sI){
+    const Long64_t slotPos = FindOrInsert(inAcc.m_binKeys[sI]);
+    m_sumw[slotPos] += scale*inAcc.m_sumw[sI];
+    m_sumw2[slotPos] += scale2*inAcc.m_sumw2[sI];
+  }
+  m_entries += inAcc.m_entries;
+  return;
+}
+
+bool sparseHistAccumulator::WriteToTHn(THnBase* inHist_p) const
+{
+  bool isSameBinning = inHist_p->GetNdimensions() == m_nDim;
+  for(Int_t dI = 0; isSameBinning && dI < m_nDim; ++dI){
+    isSameBinning = inHist_p->GetAxis(dI)->GetNbins() == m_nBins[dI];
+  }
+  if(!isSameBinning){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << inHist_p->GetName() << "' does not match the accumulator binning. return false" << std::endl;
+    return false;
+  }
+
+  std::vector<Int_t> coords(m_nDim);
+  for(unsigned int sI = 0; sI < m_binKeys.size(); ++sI){
+    ULong64_t binKey = m_binKeys[sI];
+    for(Int_t dI = 0; dI < m_nDim; ++dI){
+      coords[dI] = (Int_t)(binKey%(ULong64_t)(m_nBins[dI] + 2));
+      binKey /= (ULong64_t)(m_nBins[dI] + 2);
+    }
+
+    const Long64_t binPos = inHist_p->GetBin(coords.data(), kTRUE);
+    inHist_p->SetBinContent(binPos, m_sumw[sI]);
+    inHist_p->SetBinError2(binPos, m_sumw2[sI]);
+  }
+  inHist_p->SetEntries(m_entries);
+
+  return true;
+}
+
+bool sparseHistAccumulator::ReadFromTHn(const THnBase* inHist_p)
+{
+  bool isSameBinning = inHist_p->GetNdimensions() == m_nDim;
+  for(Int_t dI = 0; isSameBinning && dI < m_nDim; ++dI){
+    isSameBinning = inHist_p->GetAxis(dI)->GetNbins() == m_nBins[dI];
+  }
+  if(!isSameBinning){
+    std::cout << __PRETTY_FUNCTION__ << ": hist '" << inHist_p->GetName() << "' does not match the accumulator binning. return false" << std::endl;
+    return false;
+  }
+
+  //For a THnSparse GetNbins is the filled bins only; w/o sumw2 GetBinError2 returns the content, as unit weights
+  Reset();
+  std::vector<Int_t> coords(m_nDim);
+  for(Long64_t bI = 0; bI < inHist_p->GetNbins(); ++bI){
+    const Double_t binContent = inHist_p->GetBinContent(bI, coords.data());
+    const Double_t binError2 = inHist_p->GetBinError2(bI);
+    if(binContent == 0.0 && binError2 == 0.0) continue;
+
+    const Long64_t slotPos = FindOrInsert(GetBinKey(coords.data()));
+    m_sumw[slotPos] = binContent;
+    m_sumw2[slotPos] = binError2;
+  }
+  m_entries = inHist_p->GetEntries();
+
+  return true;
+}
+
+Double_t sparseHistAccumulator::GetBinContent(const Int_t* coords) const
+{
+  const Long64_t slotPos = Find(GetBinKey(coords));
+  return slotPos < 0 ? 0.0 : m_sumw[slotPos];
+}
+
+Double_t sparseHistAccumulator::GetBinError2(const Int_t* coords) const
+{
+  const Long64_t slotPos = Find(GetBinKey(coords));
+  return slotPos < 0 ? 0.0 : m_sumw2[slotPos];
+}
+
+Int_t sparseHistAccumulator::GetNDim() const {return m_nDim;}
+Long64_t sparseHistAccumulator::GetNFilledBins() const {return (Long64_t)m_binKeys.size();}
+Double_t sparseHistAccumulator::GetEntries() const {return m_entries;}
+
+Long64_t sparseHistAccumulator::GetMemoryBytes() const
+{
+  const Long64_t binBytes = (Long64_t)m_binKeys.capacity()*sizeof(ULong64_t) + (Long64_t)(m_sumw.capacity() + m_sumw2.capacity())*sizeof(Double_t);
+  const Long64_t tableBytes = (Long64_t)m_tableKeys.capacity()*sizeof(ULong64_t) + (Long64_t)m_tableSlots.capacity()*sizeof(Long64_t);
+  return binBytes + tableBytes;
+}
+
+#endif
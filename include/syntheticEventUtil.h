@@ -0,0 +1,81 @@
+#ifndef SYNTHETICEVENTUTIL_H
+#define SYNTHETICEVENTUTIL_H
+
+//c+cpp
+#include <cmath>
+#include <vector>
+
+//ROOT
+#include "TMath.h"
+#include "TRandom3.h"
+
+//Deterministic pp-like events for benchmarks, so no PYTHIA run is needed
+//nHardJets collimated sprays on top of nSoftPart soft particles; same seed -> same events
+struct syntheticEvent
+{
+  std::vector<Float_t> pt, eta, phi, m;
+  std::vector<Int_t> id;
+};
+
+inline void generateSyntheticEvent(TRandom3* randGen_p, const Int_t nHardJets, const Int_t nPartPerJet, const Int_t nSoftPart, syntheticEvent* outEvent)
+{
+  const Float_t pionMass = 0.13957;
+  const Float_t absEtaMax = 5.0;
+
+  outEvent->pt.clear();
+  outEvent->eta.clear();
+  outEvent->phi.clear();
+  outEvent->m.clear();
+  outEvent->id.clear();
+
+  for(Int_t jI = 0; jI < nHardJets; ++jI){
+    const Float_t jetPt = 30.0 + randGen_p->Exp(60.0);
+    const Float_t jetEta = randGen_p->Uniform(-2.5, 2.5);
+    const Float_t jetPhi = randGen_p->Uniform(-TMath::Pi(), TMath::Pi());
+
+    //Random momentum sharing, narrower spread for harder constituents
+    std::vector<Float_t> shares;
+    Float_t shareSum = 0.0;
+    for(Int_t pI = 0; pI < nPartPerJet; ++pI){
+      shares.push_back(randGen_p->Exp(1.0));
+      shareSum += shares.back();
+    }
+
+    for(Int_t pI = 0; pI < nPartPerJet; ++pI){
+      const Float_t partPt = jetPt*shares[pI]/shareSum;
+      const Float_t spread = 0.3/(1.0 + partPt);
+      Float_t partPhi = jetPhi + randGen_p->Gaus(0.0, spread);
+      if(partPhi > TMath::Pi()) partPhi -= 2.0*TMath::Pi();
+      else if(partPhi < -TMath::Pi()) partPhi += 2.0*TMath::Pi();
+
+      outEvent->pt.push_back(partPt);
+      outEvent->eta.push_back(jetEta + randGen_p->Gaus(0.0, spread));
+      outEvent->phi.push_back(partPhi);
+      outEvent->m.push_back(pionMass);
+      outEvent->id.push_back(pI%2 == 0 ? 211 : -211);
+    }
+  }
+
+  for(Int_t pI = 0; pI < nSoftPart; ++pI){
+    outEvent->pt.push_back(0.15 + randGen_p->Exp(0.5));
+    outEvent->eta.push_back(randGen_p->Uniform(-absEtaMax, absEtaMax));
+    outEvent->phi.push_back(randGen_p->Uniform(-TMath::Pi(), TMath::Pi()));
+    const bool isPhoton = pI%3 == 0;
+    outEvent->m.push_back(isPhoton ? 0.0 : pionMass);
+    outEvent->id.push_back(isPhoton ? 22 : 211);
+  }
+
+  return;
+}
+
+//Cartesian four-momentum of particle pI of a synthetic event
+inline void getSyntheticPxPyPzE(const syntheticEvent& inEvent, const Int_t pI, Double_t* px, Double_t* py, Double_t* pz, Double_t* e)
+{
+  *px = inEvent.pt[pI]*std::cos(inEvent.phi[pI]);
+  *py = inEvent.pt[pI]*std::sin(inEvent.phi[pI]);
+  *pz = inEvent.pt[pI]*std::sinh(inEvent.eta[pI]);
+  *e = std::sqrt((*px)*(*px) + (*py)*(*py) + (*pz)*(*pz) + inEvent.m[pI]*inEvent.m[pI]);
+  return;
+}
+
+#endif
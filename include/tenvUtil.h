@@ -1,6 +1,9 @@
 //Created Chris McGinn 2025.04.13; contact cffionn @ gmail
 //Utilities for TEnv
 
+#ifndef TENVUTIL_H
+#define TENVUTIL_H
+
 //c+cpp
 #include <iostream>
 #include <string>
@@ -68,3 +71,5 @@ bool checkAllTEnvParams(std::vector<std::string> paramList, TEnv* inConfig_p, st
   
   return allParamsFound;
 }
+
+#endif